@@ -0,0 +1,62 @@
+#include "alloc.hpp"
+#include <malloc.h>
+#include <new>
+#include <stdlib.h>
+
+static uint64_t totalAllocs = 0;
+static uint64_t totalBytes = 0;
+static int64_t liveBytes = 0;
+static int64_t peakBytes = 0;
+
+static void* track(size_t size) {
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+
+    size_t usable = malloc_usable_size(ptr);
+    totalAllocs++;
+    totalBytes += size;
+    liveBytes += usable;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return ptr;
+}
+
+static void untrack(void* ptr) {
+    if (!ptr) return;
+    liveBytes -= malloc_usable_size(ptr);
+    free(ptr);
+}
+
+void* operator new(size_t size) { return track(size); }
+void* operator new[](size_t size) { return track(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try { return track(size); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try { return track(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { untrack(ptr); }
+void operator delete[](void* ptr) noexcept { untrack(ptr); }
+void operator delete(void* ptr, size_t) noexcept { untrack(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { untrack(ptr); }
+
+namespace alloc {
+
+Snapshot now() {
+    return Snapshot{totalAllocs, totalBytes, liveBytes};
+}
+
+Snapshot begin() {
+    peakBytes = liveBytes;
+    return now();
+}
+
+void report(benchmark::State& state, const Snapshot& start) {
+    Snapshot end = now();
+    state.counters["bytes_per_op"] = benchmark::Counter(
+        (double)(end.bytes - start.bytes), benchmark::Counter::kAvgIterations);
+    state.counters["allocs_per_op"] = benchmark::Counter(
+        (double)(end.allocs - start.allocs), benchmark::Counter::kAvgIterations);
+    state.counters["peak_heap"] = (double)(peakBytes - start.current);
+}
+
+}  // namespace alloc
@@ -0,0 +1,26 @@
+#ifndef FIREMESH_BENCH_ALLOC_H
+#define FIREMESH_BENCH_ALLOC_H
+
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+
+// Contabilidad de heap: operator new/delete globales reemplazados en alloc.cpp
+namespace alloc {
+
+struct Snapshot {
+    uint64_t allocs;
+    uint64_t bytes;    // Acumulado de bytes pedidos
+    int64_t current;   // Bytes vivos
+};
+
+Snapshot now();
+
+// Arranca la medición: el pico pasa a contarse desde el heap vivo actual
+Snapshot begin();
+
+// bytes/op y allocs/op del bucle + pico de heap sobre el punto de partida
+void report(benchmark::State& state, const Snapshot& start);
+
+}  // namespace alloc
+
+#endif
@@ -0,0 +1,151 @@
+// Recuperación tras un corte del ROOT: N childs con historial y tráfico en vivo.
+//   herd:        todos vacían a la vez con flushBuffer() (DATA_HIST cada 50 ms)
+//   coordinated: BUF + GRANT de BackfillScheduler, bloques de 64 cada 250 ms
+// La subida real pasa por FirebaseManager con REQUEST_MS por petición (reloj virtual):
+// el ROOT sube como mucho una lectura cada 200 ms, así que la flota se limita a 16
+// nodos para que lo vivo quepa sin backfill.
+#include "alloc.hpp"
+#include "FirebaseManager.hpp"
+#include "BackfillScheduler.hpp"
+#include <deque>
+#include <vector>
+
+static const unsigned long REQUEST_MS = 150;     // pushJSON por TLS al RTDB
+static const unsigned long UPLOAD_TICK_MS = 50;  // taskUpload del ROOT
+static const unsigned long GRANT_TICK_MS = 500;  // BACKFILL_TICK_MS
+static const unsigned long SENSOR_MS = 5000;
+static const unsigned long HIST_GAP_MS = 50;     // flushBuffer(): delay(50)
+static const unsigned long BLOCK_GAP_MS = 250;   // BACKFILL_GAP_MS del child
+static const int BLOCK_SAMPLES = 64;
+static const int BLOCKS_PER_GRANT = 4;
+static const unsigned long HORIZON_MS = 30UL * 60UL * 1000UL;
+
+struct SimChild {
+    uint32_t id;
+    int buffered;
+    unsigned long nextLiveAt;
+    unsigned long nextHistAt;
+    int windowBlocks;
+    unsigned long nextBlockAt;
+};
+
+// Espejo de uploadQueue para medir la espera de cada lectura en vivo
+struct QueuedReading {
+    bool live;
+    unsigned long enqueuedAt;
+};
+
+static void BM_BackfillRecovery(benchmark::State& state) {
+    const bool coordinated = state.range(0) == 1;
+    const int nodes = state.range(1);
+    const int buffered = state.range(2);
+
+    double recoveryMs = 0, liveMean = 0;
+    unsigned long liveMax = 0;
+    uint32_t histDropped = 0, liveDropped = 0;
+
+    for (auto _ : state) {
+        host::setMs(0);
+        FirebaseManager fb;
+        fb.begin("api-key", "https://firemesh.local", "root@firemesh", "secret");
+        host::firebase = host::FirebaseStats();
+        host::firebase.requestMs = REQUEST_MS;
+        BackfillScheduler scheduler(1, BLOCKS_PER_GRANT);
+        String blk(std::string(200, 'A'));
+
+        std::vector<SimChild> children;
+        for (int i = 0; i < nodes; i++) {
+            SimChild c = {1000u + i, buffered, (unsigned long)i * SENSOR_MS / nodes, 0, 0, 0};
+            children.push_back(c);
+            if (coordinated) scheduler.onAdvertise(c.id, buffered, false, 0);
+        }
+
+        std::deque<QueuedReading> queue;
+        uint64_t liveSum = 0;
+        uint32_t liveCount = 0;
+        liveMax = 0;
+        histDropped = liveDropped = 0;
+        unsigned long nextUploadAt = 0, nextGrantAt = 0;
+        recoveryMs = HORIZON_MS;
+
+        for (unsigned long now = millis(); now < HORIZON_MS; host::advanceMs(10), now = millis()) {
+            bool pendingHistory = false;
+            for (SimChild& c : children) {
+                while (c.nextLiveAt <= now) {
+                    if (fb.enqueueData(200, 0, c.nextLiveAt, "DATA", c.id)) queue.push_back({true, c.nextLiveAt});
+                    else liveDropped++;
+                    c.nextLiveAt += SENSOR_MS;
+                }
+
+                if (!coordinated) {
+                    while (c.buffered > 0 && c.nextHistAt <= now) {
+                        if (fb.enqueueData(200, 0, 1, "DATA_HIST", c.id)) queue.push_back({false, now});
+                        else histDropped++;
+                        c.buffered--;
+                        c.nextHistAt += HIST_GAP_MS;
+                    }
+                } else if (c.windowBlocks > 0 && c.nextBlockAt <= now) {
+                    // El child corta la ventana si el ROOT anuncia congestión (CONGESTION_HOLD)
+                    if (fb.getCongestionLevel() < 2) {
+                        int count = c.buffered < BLOCK_SAMPLES ? c.buffered : BLOCK_SAMPLES;
+                        if (!fb.enqueueBlock(c.id, 1, 2, count, blk.c_str())) histDropped += count;
+                        c.buffered -= count;
+                        c.windowBlocks--;
+                        c.nextBlockAt = now + BLOCK_GAP_MS;
+                    } else {
+                        c.windowBlocks = 0;
+                    }
+                    if (c.windowBlocks == 0 || c.buffered == 0) {
+                        c.windowBlocks = 0;
+                        scheduler.onAdvertise(c.id, c.buffered, true, now);
+                    }
+                }
+                if (c.buffered > 0) pendingHistory = true;
+            }
+
+            if (coordinated && now >= nextGrantAt) {
+                nextGrantAt = now + GRANT_TICK_MS;
+                uint32_t id;
+                if (fb.getCongestionLevel() == 0 && scheduler.nextGrant(id, now)) {
+                    SimChild& c = children[id - 1000u];
+                    c.windowBlocks = BLOCKS_PER_GRANT;
+                    c.nextBlockAt = now;
+                }
+            }
+
+            if (now >= nextUploadAt) {
+                uint32_t before = host::firebase.requests;
+                fb.processQueue(1);
+                bool fromUploadQueue = host::firebase.requests != before &&
+                                       host::firebase.lastBody.indexOf("blk") < 0;
+                if (fromUploadQueue && !queue.empty()) {
+                    if (queue.front().live) {
+                        unsigned long wait = millis() - queue.front().enqueuedAt;
+                        liveSum += wait;
+                        liveCount++;
+                        if (wait > liveMax) liveMax = wait;
+                    }
+                    queue.pop_front();
+                }
+                nextUploadAt = millis() + UPLOAD_TICK_MS;
+            }
+
+            bool historyQueued = false;
+            for (const QueuedReading& q : queue) historyQueued = historyQueued || !q.live;
+            if (!pendingHistory && !historyQueued && fb.getBacklog() <= queue.size() &&
+                recoveryMs == HORIZON_MS) {
+                recoveryMs = now;
+            }
+        }
+        liveMean = liveCount ? (double)liveSum / liveCount : 0;
+    }
+    state.counters["recovery_s"] = recoveryMs / 1000.0;
+    state.counters["live_mean_ms"] = liveMean;
+    state.counters["live_max_ms"] = liveMax;
+    state.counters["hist_dropped"] = histDropped;
+    state.counters["live_dropped"] = liveDropped;
+}
+BENCHMARK(BM_BackfillRecovery)
+    ->ArgNames({"coord", "nodes", "buffered"})
+    ->ArgsProduct({{0, 1}, {8, 16}, {120, 640}})
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,57 @@
+// Buffer offline del CHILD: inserción con compactación y vaciado en bloques
+#include "alloc.hpp"
+#include "SyncManager.hpp"
+
+static size_t sentFrames = 0;
+static size_t sentBytes = 0;
+
+static void countFrame(const String& msg) {
+    sentFrames++;
+    sentBytes += msg.length();
+}
+
+static DataPacket reading(unsigned long long ts, int i) {
+    return DataPacket{ts, 400 + (i * 7) % 23, (uint8_t)(i % 97 == 0)};
+}
+
+// Lectura nueva con el buffer lleno: cada inserción fuerza una compactación
+static void BM_AddToBufferFull(benchmark::State& state) {
+    const int capacity = state.range(0);
+    painlessMesh mesh;
+    SyncManager sync(&mesh, capacity);
+
+    unsigned long long ts = 1000000ULL;
+    int i = 0;
+    for (; i < capacity; i++, ts += 5000) sync.addToBuffer(reading(ts, i));
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        sync.addToBuffer(reading(ts, i++));
+        ts += 5000;
+    }
+    alloc::report(state, start);
+    state.counters["compactions"] = sync.getCompactions();
+}
+BENCHMARK(BM_AddToBufferFull)->Arg(200)->Arg(2000);
+
+// Reconexión: vaciar N lecturas en bloques comprimidos
+static void BM_FlushBufferBlocks(benchmark::State& state) {
+    const int count = state.range(0);
+    painlessMesh mesh;
+    mesh.nodeId = 3710082173u;
+    SyncManager sync(&mesh, count);
+    sentFrames = sentBytes = 0;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < count; i++) sync.addToBuffer(reading(1000000ULL + i * 5000ULL, i));
+        state.ResumeTiming();
+        sync.flushBufferBlocks(countFrame);
+    }
+    alloc::report(state, start);
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["frames"] = (double)sentFrames / state.iterations();
+    state.counters["bytes_per_reading"] = (double)sentBytes / (state.iterations() * count);
+}
+BENCHMARK(BM_FlushBufferBlocks)->Arg(64)->Arg(640);
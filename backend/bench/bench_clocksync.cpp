@@ -0,0 +1,174 @@
+// Sincronización de reloj con N childs: mensajes del ROOT por minuto y error de
+// la hora de red en cada nodo. Modelo de eventos con los parámetros del firmware:
+//   - beacon SYNC del ROOT cada 10 s (taskAnnounceRoot), difundido por la malla
+//   - cada child filtra el beacon como SyncManager::handleSyncBeacon (ganancia
+//     0.25, salto si el error pasa de 500 ms) y calibra con TIME (T1..T4) cada
+//     6 beacons, en su taskSync de 10 s con fase propia
+//   - el ROOT atiende los TIME de uno en uno: la espera en su cola entra entre
+//     T1 y T2 y sesga el offset medido
+// Árbol de grado 4 (saltos = profundidad), 5 ms + |N(0, 8 ms)| por salto, deriva
+// del cristal uniforme en ±30 ppm.
+#include "alloc.hpp"
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <vector>
+
+static const double BEACON_MS = 10000;      // taskAnnounceRoot
+static const double SYNC_TASK_MS = 10000;   // SYNC_INTERVAL_MS del child
+static const int CALIBRATION_EVERY = 6;     // SyncManager(..., calibrationEvery = 6)
+static const double BEACON_GAIN = 0.25;
+static const double STEP_THRESHOLD_MS = 500.0;
+static const double ROOT_SERVICE_MS = 3.0;  // Parseo + respuesta TIME en el ROOT
+static const double HOP_BASE_MS = 5.0;
+static const double HOP_JITTER_MS = 8.0;
+static const double DRIFT_PPM = 30.0;
+static const double HORIZON_MS = 30.0 * 60.0 * 1000.0;
+static const double WARMUP_MS = 3.0 * 60.0 * 1000.0;
+
+struct SimNode {
+    int hops;
+    double drift;       // Fracción: reloj local = t * (1 + drift) + boot
+    double boot;
+    double timeOffset = 0;
+    double pathDelay = 0;
+    bool synchronized = false;
+    bool calibrated = false;
+    int beaconsSinceCalibration = 0;
+    bool requestInFlight = false;
+
+    double local(double t) const { return t * (1.0 + drift) + boot; }
+    double networkTime(double t) const { return local(t) + timeOffset; }
+};
+
+enum EventType { BEACON_ARRIVE, SYNC_TICK, REQUEST_AT_ROOT, RESPONSE_ARRIVE, SAMPLE };
+
+struct Event {
+    double at;
+    EventType type;
+    int node;
+    double rootTs, T1, T2, T3;
+    bool operator>(const Event& other) const { return at > other.at; }
+};
+
+static void BM_ClockSyncFleet(benchmark::State& state) {
+    const int nodes = state.range(0);
+    double rootPerMin = 0, framesPerMin = 0, beaconBytes = 0;
+    double errMean = 0, errP99 = 0, errMax = 0, queueMaxMs = 0;
+
+    for (auto _ : state) {
+        std::mt19937 rng(5);
+        std::normal_distribution<double> jitter(0.0, HOP_JITTER_MS);
+        std::uniform_real_distribution<double> drift(-DRIFT_PPM * 1e-6, DRIFT_PPM * 1e-6);
+        std::uniform_real_distribution<double> phase(0.0, SYNC_TASK_MS);
+        std::uniform_real_distribution<double> boot(0.0, 60000.0);
+
+        auto pathMs = [&](int hops) {
+            double ms = 0;
+            for (int h = 0; h < hops; h++) ms += HOP_BASE_MS + fabs(jitter(rng));
+            return ms;
+        };
+
+        std::vector<SimNode> fleet(nodes);
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+        for (int i = 0; i < nodes; i++) {
+            int depth = 1;
+            for (long span = 4, first = 0; i >= first + span; first += span, span *= 4) depth++;
+            fleet[i].hops = depth;
+            fleet[i].drift = drift(rng);
+            fleet[i].boot = boot(rng);
+            events.push({phase(rng), SYNC_TICK, i, 0, 0, 0, 0});
+        }
+        for (double t = 0; t < HORIZON_MS; t += BEACON_MS) {
+            for (int i = 0; i < nodes; i++) {
+                events.push({t + pathMs(fleet[i].hops), BEACON_ARRIVE, i, t, 0, 0, 0});
+            }
+        }
+        for (double t = WARMUP_MS; t < HORIZON_MS; t += 1000) events.push({t, SAMPLE, -1, 0, 0, 0, 0});
+
+        uint64_t rootMessages = (uint64_t)(HORIZON_MS / BEACON_MS);
+        uint64_t frames = rootMessages * nodes;  // Cada nodo reenvía el broadcast una vez
+        double rootFreeAt = 0;
+        std::vector<double> errors;
+        queueMaxMs = 0;
+
+        while (!events.empty()) {
+            Event ev = events.top();
+            events.pop();
+            if (ev.at >= HORIZON_MS) break;
+            SimNode* n = ev.node >= 0 ? &fleet[ev.node] : nullptr;
+
+            switch (ev.type) {
+            case BEACON_ARRIVE: {
+                n->beaconsSinceCalibration++;
+                if (!n->calibrated) break;
+                double estimate = ev.rootTs + n->pathDelay - n->local(ev.at);
+                if (!n->synchronized) {
+                    n->timeOffset = estimate;
+                    n->synchronized = true;
+                    break;
+                }
+                double err = estimate - n->timeOffset;
+                if (fabs(err) > STEP_THRESHOLD_MS) n->timeOffset = estimate;
+                else n->timeOffset += BEACON_GAIN * err;
+                break;
+            }
+            case SYNC_TICK: {
+                events.push({ev.at + SYNC_TASK_MS, SYNC_TICK, ev.node, 0, 0, 0, 0});
+                bool needs = !n->calibrated || n->beaconsSinceCalibration >= CALIBRATION_EVERY;
+                if (!needs || n->requestInFlight) break;
+                n->requestInFlight = true;
+                frames += n->hops;
+                events.push({ev.at + pathMs(n->hops), REQUEST_AT_ROOT, ev.node, 0, n->local(ev.at), 0, 0});
+                break;
+            }
+            case REQUEST_AT_ROOT: {
+                // Reloj del ROOT = tiempo real del modelo
+                double start = std::max(ev.at, rootFreeAt);
+                queueMaxMs = std::max(queueMaxMs, start - ev.at);
+                rootFreeAt = start + ROOT_SERVICE_MS;
+                rootMessages++;
+                frames += n->hops;
+                events.push({rootFreeAt + pathMs(n->hops), RESPONSE_ARRIVE, ev.node, 0,
+                             ev.T1, start, rootFreeAt});
+                break;
+            }
+            case RESPONSE_ARRIVE: {
+                double T4 = n->local(ev.at);
+                n->timeOffset = ((ev.T2 - ev.T1) + (ev.T3 - T4)) / 2.0;
+                n->pathDelay = ((T4 - ev.T1) - (ev.T3 - ev.T2)) / 2.0;
+                n->synchronized = n->calibrated = true;
+                n->beaconsSinceCalibration = 0;
+                n->requestInFlight = false;
+                break;
+            }
+            case SAMPLE:
+                for (const SimNode& s : fleet) {
+                    if (s.synchronized) errors.push_back(fabs(s.networkTime(ev.at) - ev.at));
+                }
+                break;
+            }
+        }
+
+        std::sort(errors.begin(), errors.end());
+        double sum = 0;
+        for (double e : errors) sum += e;
+        errMean = errors.empty() ? 0 : sum / errors.size();
+        errP99 = errors.empty() ? 0 : errors[(size_t)(errors.size() * 0.99)];
+        errMax = errors.empty() ? 0 : errors.back();
+        rootPerMin = rootMessages / (HORIZON_MS / 60000.0);
+        framesPerMin = frames / (HORIZON_MS / 60000.0);
+        // {"type":"SYNC","root":..,"ts":..,"slots":[...]}: ~11 bytes por ID en el arreglo
+        beaconBytes = 60 + 11.0 * nodes;
+    }
+    state.counters["root_msgs_min"] = rootPerMin;
+    state.counters["mesh_frames_min"] = framesPerMin;
+    state.counters["beacon_bytes"] = beaconBytes;
+    state.counters["err_mean_ms"] = errMean;
+    state.counters["err_p99_ms"] = errP99;
+    state.counters["err_max_ms"] = errMax;
+    state.counters["root_queue_max_ms"] = queueMaxMs;
+}
+BENCHMARK(BM_ClockSyncFleet)
+    ->ArgName("nodes")->Arg(16)->Arg(64)->Arg(256)->Arg(1024)
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
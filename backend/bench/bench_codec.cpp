@@ -0,0 +1,78 @@
+// Bloques DATA_BLK: coste de codificar y tamaño frente a un frame DATA_HIST por lectura
+#include "alloc.hpp"
+#include "HistoryCodec.hpp"
+#include <random>
+#include <vector>
+
+static const uint32_t CHILD_ID = 3710082173u;
+static const size_t BLOCK_SAMPLES = 64;   // flushBufferBlocks(sendRaw, 64, 1) en child.cpp
+static const double BACKFILL_GAP_MS = 250; // Un bloque por BACKFILL_GAP_MS dentro del GRANT
+static const double LEGACY_GAP_MS = 50;    // flushBuffer(): delay(50) por lectura
+
+enum Cadence { REGULAR = 0, TICK_JITTER = 1, IRREGULAR = 2 };
+
+// Humo como paseo aleatorio suave; cadencia según el escenario
+static std::vector<DataPacket> history(Cadence cadence, size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-6, 6);
+    std::uniform_int_distribution<int> jitter(-20, 20);
+    std::uniform_int_distribution<int> gap(1000, 20000);
+
+    std::vector<DataPacket> out;
+    unsigned long long ts = 3600000ULL;  // Hora de red: millis() del ROOT
+    int humo = 250;
+    for (size_t i = 0; i < count; i++) {
+        humo = constrain(humo + step(rng), 0, 4095);
+        out.push_back(DataPacket{ts, humo, (uint8_t)(i % 50 == 49)});
+        if (cadence == REGULAR) ts += 5000;
+        else if (cadence == TICK_JITTER) ts += 5000 + jitter(rng);
+        else ts += gap(rng);
+    }
+    return out;
+}
+
+// Mismo formato que createDataJSON / createBlockJSON, sin pasar por ArduinoJson
+static size_t dataHistFrame(const DataPacket& p) {
+    char buf[160];
+    return snprintf(buf, sizeof(buf),
+                    "{\"type\":\"DATA_HIST\",\"src\":%u,\"body\":{\"ts\":%llu,\"humo\":%d,\"fuego\":%d}}",
+                    CHILD_ID, p.timestamp, p.humo, p.fuego);
+}
+
+static size_t blockFrameOverhead(HistoryEncoder& enc) {
+    char buf[160];
+    return snprintf(buf, sizeof(buf),
+                    "{\"type\":\"DATA_BLK\",\"src\":%u,\"body\":{\"t0\":%llu,\"t1\":%llu,\"n\":%u,\"blk\":\"\"}}",
+                    CHILD_ID, enc.getFirstTs(), enc.getLastTs(), (unsigned)enc.count());
+}
+
+static void BM_HistoryBlock(benchmark::State& state) {
+    std::vector<DataPacket> samples = history((Cadence)state.range(0), BLOCK_SAMPLES);
+    HistoryEncoder enc(BLOCK_SAMPLES);
+    size_t b64 = 0;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        enc.reset();
+        for (const DataPacket& p : samples) enc.add(p);
+        String blk = enc.toBase64();
+        b64 = blk.length();
+        benchmark::DoNotOptimize(blk.c_str());
+    }
+    alloc::report(state, start);
+
+    size_t raw = 0;
+    for (const DataPacket& p : samples) raw += dataHistFrame(p);
+    size_t frame = blockFrameOverhead(enc) + b64;
+    size_t blocks = (samples.size() + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES;
+
+    state.SetItemsProcessed(state.iterations() * samples.size());
+    state.counters["bits_per_sample"] = enc.encodedSize() * 8.0 / enc.count();
+    state.counters["b64_chars"] = b64;
+    state.counters["frame_bytes"] = frame;
+    state.counters["ratio_vs_hist"] = (double)raw / frame;
+    // Tiempo de vaciado del bloque: un frame por ventana frente a 64 envíos espaciados
+    state.counters["drain_ms"] = blocks * BACKFILL_GAP_MS;
+    state.counters["legacy_drain_ms"] = samples.size() * LEGACY_GAP_MS;
+}
+BENCHMARK(BM_HistoryBlock)->Arg(REGULAR)->Arg(TICK_JITTER)->Arg(IRREGULAR);
@@ -0,0 +1,102 @@
+// Detectores en streaming del ROOT: coste por lectura con miles de nodos
+#include "alloc.hpp"
+#include "FireDetector.hpp"
+#include <vector>
+
+static uint32_t alertsRaised = 0;
+
+static void countAlert(const FireEvent&) {
+    alertsRaised++;
+}
+
+// Flota estable: humo de fondo con ruido, lecturas cada 5 s en orden de slot
+static void BM_FireDetectorUpdate(benchmark::State& state) {
+    const int nodes = state.range(0);
+    FireDetector detector;
+    detector.onEvent(&countAlert);
+    alertsRaised = 0;
+
+    std::vector<int> noise(1024);
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = 180 + random(0, 40);
+
+    unsigned long long ts = 1000000ULL;
+    for (int n = 0; n < nodes; n++) detector.update(1000u + n, ts, noise[n % noise.size()], 0);
+
+    int n = 0;
+    size_t k = 0;
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        detector.update(1000u + n, ts, noise[k++ & 1023], 0);
+        if (++n == nodes) {
+            n = 0;
+            ts += 5000;
+        }
+    }
+    alloc::report(state, start);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["nodes"] = detector.trackedNodes();
+    state.counters["alerts"] = alertsRaised;
+}
+BENCHMARK(BM_FireDetectorUpdate)->Arg(1000)->Arg(4000)->Arg(16000);
+
+// Alta y baja de nodos: forget() devuelve la memoria del estado
+static void BM_FireDetectorChurn(benchmark::State& state) {
+    const int nodes = state.range(0);
+    FireDetector detector;
+    for (int n = 0; n < nodes; n++) detector.update(1000u + n, 1000000ULL, 200, 0);
+
+    uint32_t next = 1000u + nodes;
+    uint32_t oldest = 1000u;
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        detector.forget(oldest++);
+        detector.update(next++, 1000000ULL, 200, 0);
+    }
+    alloc::report(state, start);
+    state.counters["nodes"] = detector.trackedNodes();
+}
+BENCHMARK(BM_FireDetectorChurn)->Arg(1000);
+
+// Fuego lento (humo de 220 a 560, bajo smokeCritical = 600) con el ROOT
+// congestionado 15 min desde 2 min antes del inicio: el child retiene las
+// lecturas normales y salen luego como DATA_BLK, que no pasa por los detectores.
+//   local=0: solo fuego o humo crítico salen en vivo
+//   local=1: además las que el detector propio del child ve en subida
+static unsigned long long firstRootAlert = 0;
+
+static void recordRootAlert(const FireEvent& evt) {
+    if (firstRootAlert == 0) firstRootAlert = evt.ts;
+}
+
+static void BM_SlowFireUnderCongestion(benchmark::State& state) {
+    const bool local = state.range(0) == 1;
+    const unsigned long long fireAt = 600000ULL;
+    const unsigned long long holdFrom = fireAt - 120000ULL, holdUntil = holdFrom + 900000ULL;
+    const uint32_t self = 1000u;
+    double latencyS = 0;
+    uint32_t liveDuringHold = 0;
+
+    for (auto _ : state) {
+        FireDetector root, child;
+        root.onEvent(&recordRootAlert);
+        firstRootAlert = 0;
+        liveDuringHold = 0;
+
+        for (unsigned long long ts = 5000; ts < 2400000ULL; ts += 5000) {
+            int humo = 220 + random(-10, 10);
+            if (ts >= fireAt) humo += min((int)((ts - fireAt) / 2000), 340);  // 0.5 unidades/s
+
+            child.update(self, ts, humo, 0);
+            bool congested = ts >= holdFrom && ts < holdUntil;
+            bool critical = humo >= 600 || (local && child.isAlerting(self));
+            if (congested && !critical) continue;
+
+            if (congested) liveDuringHold++;
+            root.update(self, ts, humo, 0);
+        }
+        latencyS = firstRootAlert > fireAt ? (firstRootAlert - fireAt) / 1000.0 : -1;
+    }
+    state.counters["root_detect_s"] = latencyS;
+    state.counters["live_during_hold"] = liveDuringHold;
+}
+BENCHMARK(BM_SlowFireUnderCongestion)->ArgName("local")->Arg(0)->Arg(1)->Iterations(1);
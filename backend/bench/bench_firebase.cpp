@@ -0,0 +1,90 @@
+// Cola de ingesta del ROOT y construcción de payloads de Firebase
+#include "alloc.hpp"
+#include "FirebaseManager.hpp"
+
+static void startFirebase(FirebaseManager& fb) {
+    fb.begin("api-key", "https://firemesh.local", "root@firemesh", "secret");
+    host::firebase = host::FirebaseStats();
+}
+
+// Payload de una lectura en vivo: FirebaseJson + ruta (sin red)
+static void BM_FirebaseSendData(benchmark::State& state) {
+    FirebaseManager fb;
+    startFirebase(fb);
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fb.sendData(420, 0, 123456789ULL, "DATA", 3710082173u));
+    }
+    alloc::report(state, start);
+    state.counters["payload_bytes"] = (double)host::firebase.payloadBytes / state.iterations();
+}
+BENCHMARK(BM_FirebaseSendData);
+
+// Lo que hace taskUpload por lectura: encolar + una subida
+static void BM_FirebaseQueueRoundTrip(benchmark::State& state) {
+    FirebaseManager fb;
+    startFirebase(fb);
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        fb.enqueueData(420, 0, 123456789ULL, "DATA", 3710082173u);
+        benchmark::DoNotOptimize(fb.processQueue(1));
+    }
+    alloc::report(state, start);
+}
+BENCHMARK(BM_FirebaseQueueRoundTrip);
+
+// Ráfaga: llenar la cola hasta N y vaciarla (coste por lectura)
+static void BM_FirebaseQueueBurst(benchmark::State& state) {
+    const int burst = state.range(0);
+    FirebaseManager fb(burst);
+    startFirebase(fb);
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        for (int i = 0; i < burst; i++) {
+            fb.enqueueData(400 + i, 0, 123456789ULL + i * 5000ULL, "DATA", 1000u + i);
+        }
+        while (fb.getBacklog() > 0) fb.processQueue(8);
+    }
+    alloc::report(state, start);
+    state.SetItemsProcessed(state.iterations() * burst);
+}
+BENCHMARK(BM_FirebaseQueueBurst)->Arg(16)->Arg(64);
+
+// Estado de un child: JSON ya serializado reenviado con setJSON
+static void BM_FirebaseSendStatus(benchmark::State& state) {
+    FirebaseManager fb;
+    startFirebase(fb);
+    String status = "{\"heap\":182000,\"maxBlk\":110000,\"minHeap\":150000,\"buf\":0,\"up\":3600}";
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fb.sendStatus(3710082173u, status));
+    }
+    alloc::report(state, start);
+}
+BENCHMARK(BM_FirebaseSendStatus);
+
+// Cola llena por congestión: las lecturas críticas desplazan a las normales;
+// solo se pierde una crítica si la cola entera ya es crítica
+static void BM_FirebaseQueueCriticalHeadroom(benchmark::State& state) {
+    const int critical = state.range(0);
+    uint32_t criticalDropped = 0, dropped = 0;
+
+    for (auto _ : state) {
+        FirebaseManager fb;
+        startFirebase(fb);
+        for (int i = 0; i < 64; i++) fb.enqueueData(250, 0, 1000000ULL + i, "DATA", 1000u + i);
+
+        criticalDropped = 0;
+        for (int i = 0; i < critical; i++) {
+            if (!fb.enqueueData(900, 1, 2000000ULL + i, "DATA_FIRE", 3000u + i, true)) criticalDropped++;
+        }
+        dropped = fb.getDroppedUploads();
+    }
+    state.counters["critical_dropped"] = criticalDropped;
+    state.counters["normal_evicted"] = dropped - criticalDropped;
+}
+BENCHMARK(BM_FirebaseQueueCriticalHeadroom)->Arg(16)->Arg(80)->Iterations(1);
@@ -0,0 +1,101 @@
+// Mensajes de la malla: construcción en el child y parseo en el ROOT
+#include "alloc.hpp"
+#include "SyncManager.hpp"
+
+static const uint32_t CHILD_ID = 3710082173u;
+
+// Frame DATA de una lectura (SyncManager::createDataJSON)
+static void BM_CreateDataJSON(benchmark::State& state) {
+    painlessMesh mesh;
+    SyncManager sync(&mesh);
+    DataPacket reading{123456789ULL, 420, 0};
+    size_t frameBytes = 0;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        String msg = sync.createDataJSON(reading, "DATA", CHILD_ID);
+        frameBytes = msg.length();
+        benchmark::DoNotOptimize(msg.c_str());
+    }
+    alloc::report(state, start);
+    state.counters["frame_bytes"] = frameBytes;
+}
+BENCHMARK(BM_CreateDataJSON);
+
+// Mismo documento y accesos que receivedCallback del ROOT para un DATA
+static void BM_RootParseData(benchmark::State& state) {
+    painlessMesh mesh;
+    SyncManager sync(&mesh);
+    String msg = sync.createDataJSON(DataPacket{123456789ULL, 420, 1}, "DATA", CHILD_ID);
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        StaticJsonDocument<1024> doc;
+        DeserializationError err = deserializeJson(doc, msg);
+        const char* type = doc["type"] | "";
+        uint32_t src = doc["src"];
+        unsigned long long ts = doc["body"]["ts"];
+        int humo = doc["body"]["humo"];
+        benchmark::DoNotOptimize(err);
+        benchmark::DoNotOptimize(type);
+        benchmark::DoNotOptimize(src + ts + humo);
+    }
+    alloc::report(state, start);
+}
+BENCHMARK(BM_RootParseData);
+
+static std::list<uint32_t> fleet(int nodes) {
+    std::list<uint32_t> ids;
+    for (int i = 0; i < nodes; i++) ids.push_back(1000u + i);
+    return ids;
+}
+
+// Beacon SYNC del ROOT con la tabla de slots de N nodos
+static void BM_CreateSyncBeacon(benchmark::State& state) {
+    painlessMesh mesh;
+    SyncManager sync(&mesh);
+    sync.updateSlots(fleet(state.range(0)));
+    size_t frameBytes = 0;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        String msg = sync.createSyncBeacon(1);
+        frameBytes = msg.length();
+        benchmark::DoNotOptimize(msg.c_str());
+    }
+    alloc::report(state, start);
+    state.counters["frame_bytes"] = frameBytes;
+}
+BENCHMARK(BM_CreateSyncBeacon)->Arg(0)->Arg(16)->Arg(64)->Arg(256)->Arg(1024);
+
+// Child: parseo del beacon (documento dimensionado con docCapacityFor) + búsqueda
+// del slot propio. fixed2048_ok indica si el StaticJsonDocument<2048> anterior
+// todavía lo parseaba.
+static void BM_ChildHandleSyncBeacon(benchmark::State& state) {
+    painlessMesh rootMesh;
+    SyncManager root(&rootMesh);
+    root.updateSlots(fleet(state.range(0)));
+    String msg = root.createSyncBeacon(0);
+
+    painlessMesh childMesh;
+    childMesh.nodeId = 1000u + state.range(0) / 2;
+    SyncManager child(&childMesh);
+
+    StaticJsonDocument<2048> fixed;
+    bool fixedOk = !deserializeJson(fixed, msg);
+    bool parsed = false;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        DynamicJsonDocument doc(SyncManager::docCapacityFor(msg));
+        parsed = !deserializeJson(doc, msg);
+        child.handleSyncBeacon(doc);
+        benchmark::DoNotOptimize(child.hasSlot());
+    }
+    alloc::report(state, start);
+    state.counters["frame_bytes"] = msg.length();
+    state.counters["doc_bytes"] = SyncManager::docCapacityFor(msg);
+    state.counters["parsed"] = parsed && child.hasSlot();
+    state.counters["fixed2048_ok"] = fixedOk;
+}
+BENCHMARK(BM_ChildHandleSyncBeacon)->Arg(16)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
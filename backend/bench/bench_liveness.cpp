@@ -0,0 +1,127 @@
+// Detector phi-accrual del CHILD bajo jitter simulado: falsos positivos por
+// hora con el ROOT vivo y latencia de detección cuando cae.
+// Parámetros como en child.cpp: heartbeat 500 ms, phi 8, cota 2000 ms, sondeo 50 ms.
+#include "alloc.hpp"
+#include "FailureDetector.hpp"
+#include <random>
+
+static const unsigned long HB_MS = 500;
+static const unsigned long CHECK_MS = 50;
+static const double PHI = 8.0;
+static const unsigned long MAX_SILENCE = 2000;
+
+// Retardo de la malla: base fija + semi-normal de desviación sigma; pérdidas con prob. loss
+struct Link {
+    std::mt19937 rng;
+    std::normal_distribution<double> jitter;
+    std::uniform_real_distribution<double> coin;
+    double loss;
+
+    Link(double sigmaMs, double loss) : rng(42), jitter(0.0, sigmaMs), coin(0.0, 1.0), loss(loss) {}
+
+    // Instante de llegada del heartbeat enviado en sentAt (0 = perdido)
+    unsigned long arrival(unsigned long sentAt, unsigned long lastArrival) {
+        if (coin(rng) < loss) return 0;
+        unsigned long at = sentAt + 5 + (unsigned long)fabs(jitter(rng));
+        return at > lastArrival ? at : lastArrival;  // La malla no reordena
+    }
+};
+
+// Una hora con el ROOT vivo: cada sospecha es un falso positivo
+static void BM_LivenessFalsePositives(benchmark::State& state) {
+    const double sigma = state.range(0);
+    const double loss = state.range(1) / 1000.0;
+    const unsigned long horizon = 3600UL * 1000UL;
+    uint32_t suspicions = 0;
+    uint64_t checks = 0;
+
+    for (auto _ : state) {
+        Link link(sigma, loss);
+        FailureDetector fd(PHI, MAX_SILENCE);
+        suspicions = 0;
+        checks = 0;
+
+        bool suspected = false;
+        unsigned long lastArrival = 0;
+        unsigned long nextArrival = link.arrival(1000, 0);
+        unsigned long sent = 1000;
+        for (unsigned long now = 1000; now < horizon; now += CHECK_MS) {
+            while (nextArrival != 0 ? nextArrival <= now : sent + HB_MS <= now) {
+                if (nextArrival != 0) {
+                    fd.heartbeat(nextArrival);
+                    lastArrival = nextArrival;
+                    suspected = false;
+                }
+                sent += HB_MS;
+                nextArrival = link.arrival(sent, lastArrival);
+            }
+            checks++;
+            if (!suspected && fd.isSuspected(now)) {
+                suspected = true;
+                suspicions++;
+            }
+        }
+    }
+    state.counters["fp_per_hour"] = suspicions;
+    state.counters["checks"] = (double)checks;
+}
+BENCHMARK(BM_LivenessFalsePositives)
+    ->Args({10, 0})->Args({50, 0})->Args({150, 0})->Args({50, 50})->Args({150, 50})
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// El ROOT cae en un instante aleatorio tras 60 s de heartbeats: tiempo hasta sospechar
+static void BM_LivenessDetection(benchmark::State& state) {
+    const double sigma = state.range(0);
+    const double loss = state.range(1) / 1000.0;
+    const int trials = 500;
+    double sumMs = 0;
+    unsigned long maxMs = 0;
+    int cappedByBound = 0;
+
+    for (auto _ : state) {
+        Link link(sigma, loss);
+        std::uniform_int_distribution<unsigned long> crashOffset(0, HB_MS - 1);
+        sumMs = 0;
+        maxMs = 0;
+        cappedByBound = 0;
+
+        for (int t = 0; t < trials; t++) {
+            FailureDetector fd(PHI, MAX_SILENCE);
+            unsigned long crashAt = 61000 + crashOffset(link.rng);
+            unsigned long lastArrival = 0;
+            for (unsigned long sent = 1000; sent < crashAt; sent += HB_MS) {
+                unsigned long at = link.arrival(sent, lastArrival);
+                if (at == 0) continue;
+                fd.heartbeat(at);
+                lastArrival = at;
+            }
+
+            // Sondeo cada CHECK_MS, como taskLiveness
+            unsigned long now = crashAt - crashAt % CHECK_MS + CHECK_MS;
+            while (!fd.isSuspected(now)) now += CHECK_MS;
+
+            unsigned long latency = now - crashAt;
+            sumMs += latency;
+            if (latency > maxMs) maxMs = latency;
+            if (fd.phi(now) < PHI) cappedByBound++;
+        }
+    }
+    state.counters["detect_mean_ms"] = sumMs / trials;
+    state.counters["detect_max_ms"] = maxMs;
+    state.counters["by_max_silence"] = cappedByBound;
+}
+BENCHMARK(BM_LivenessDetection)
+    ->Args({10, 0})->Args({50, 0})->Args({150, 0})->Args({50, 50})->Args({150, 50})
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Coste de una comprobación (taskLiveness corre cada 50 ms)
+static void BM_LivenessCheck(benchmark::State& state) {
+    FailureDetector fd(PHI, MAX_SILENCE);
+    for (unsigned long t = 500; t <= 500 * (FD_WINDOW + 1); t += 500) fd.heartbeat(t + t % 37);
+
+    unsigned long now = 500 * (FD_WINDOW + 1) + 100;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fd.isSuspected(now));
+    }
+}
+BENCHMARK(BM_LivenessCheck);
@@ -0,0 +1,99 @@
+// Jitter del loop del child según cómo salen los logs: Serial.printf directo
+// (-DLOG_INLINE) frente al ring diferido + Log::drain() en cada vuelta.
+// Modelo: UART a 115200 con la FIFO de TX de 128 bytes (shim), 100 us de trabajo
+// por vuelta del loop y una ráfaga de N logs por tick de 5 s. El hueco entre
+// vueltas se mide sobre el reloj virtual como Log::measureLoop(); el coste de
+// CPU del formateo no avanza el reloj (ver la columna Time).
+// Este archivo se compila con LOG_LEVEL=3 (ver CMakeLists.txt).
+#include "alloc.hpp"
+#include "Log.hpp"
+
+static const unsigned long LOOP_WORK_US = 100;
+static const unsigned long TICK_US = 5000000;
+static const unsigned long WINDOW_US = 60000000;
+
+template <typename... Args>
+static void emit(bool inlineLog, const char* fmt, Args... args) {
+    if (inlineLog) {
+        // LOG_EMIT con -DLOG_INLINE
+        Serial.printf(fmt, args...);
+        Serial.println();
+    } else {
+        Log::write(LOG_LEVEL_INFO, fmt, args...);
+    }
+}
+
+// Mensajes reales del child, en el orden en que salen tras un tick cargado
+static void logBurst(bool inlineLog, int lines, unsigned long ts) {
+    for (int i = 0; i < lines; i++) {
+        switch (i % 4) {
+            case 0: emit(inlineLog, "[SYNC] ROOT actualizado: %u (desde nodo %u)", 3710082173u, 2805856045u); break;
+            case 1: emit(inlineLog, "[Buffer] %u lecturas (%u B) cubren %llu s | %u compactaciones",
+                         240u, 3840u, (unsigned long long)ts / 1000, 3u); break;
+            case 2: emit(inlineLog, "[FD] ROOT sospechoso: silencio %lu ms, phi %.1f → buffering", 4200ul, 8.3); break;
+            case 3: emit(inlineLog, "[MESH] Topología cambió (%d nodos visibles)", 12); break;
+        }
+    }
+}
+
+static void BM_LogLoopJitter(benchmark::State& state) {
+    const bool inlineLog = state.range(0) == 1;
+    const int lines = state.range(1);
+    double gapMax = 0, gapMean = 0, blockedMs = 0;
+    uint32_t dropped = 0;
+
+    for (auto _ : state) {
+        host::setMs(0);
+        host::uart = host::UartModel();
+        host::uart.baud = 115200;
+        uint32_t droppedStart = Log::getDropped();
+
+        uint64_t last = host::clockUs, sum = 0, count = 0, worst = 0;
+        uint64_t nextTick = TICK_US;
+
+        while (host::clockUs < WINDOW_US) {
+            host::advanceUs(LOOP_WORK_US);
+            if (host::clockUs >= nextTick) {
+                logBurst(inlineLog, lines, host::clockUs / 1000);
+                nextTick += TICK_US;
+            }
+            Log::drain();
+
+            uint64_t gap = host::clockUs - last;
+            worst = std::max(worst, gap);
+            sum += gap;
+            count++;
+            last = host::clockUs;
+        }
+
+        // Vaciar el ring para la próxima iteración (fuera de la medida)
+        host::uart.baud = 0;
+        Log::drain(LOG_RING_SIZE);
+
+        gapMax = worst;
+        gapMean = count ? (double)sum / count : 0;
+        blockedMs = host::uart.blockedUs / 1000.0;
+        dropped = Log::getDropped() - droppedStart;
+    }
+    state.counters["gap_max_us"] = gapMax;
+    state.counters["gap_mean_us"] = gapMean;
+    state.counters["uart_blocked_ms"] = blockedMs;
+    state.counters["dropped"] = dropped;
+}
+BENCHMARK(BM_LogLoopJitter)
+    ->ArgNames({"inline", "lines"})
+    ->ArgsProduct({{0, 1}, {1, 4, 16}})
+    ->Iterations(3);
+
+// Coste de CPU de una llamada: formateo + UART directo frente a reservar el registro
+static void BM_LogCall(benchmark::State& state) {
+    const bool inlineLog = state.range(0) == 1;
+    host::uart = host::UartModel();
+
+    for (auto _ : state) {
+        emit(inlineLog, "[Buffer] %u lecturas (%u B) cubren %llu s | %u compactaciones",
+             240u, 3840u, 1200ULL, 3u);
+        if (!inlineLog) Log::drain(LOG_RING_SIZE);
+    }
+}
+BENCHMARK(BM_LogCall)->ArgName("inline")->Arg(0)->Arg(1);
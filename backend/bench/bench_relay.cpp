@@ -0,0 +1,80 @@
+// Relay con K hojas aguas abajo: frames y bytes hacia el ROOT por tick,
+// enrutado por lectura (DATA) frente a agregado (AGG)
+#include "alloc.hpp"
+#include "SyncManager.hpp"
+#include "RelayAggregator.hpp"
+
+static const uint32_t ROOT_ID = 1;
+static const uint32_t RELAY_ID = 2;
+
+// Árbol visto desde el relay: el ROOT por un lado, las hojas por otro
+static void buildRelay(painlessMesh& mesh, int leaves) {
+    mesh.nodeId = RELAY_ID;
+    mesh.tree.subs.clear();
+    painlessmesh::protocol::NodeTree root;
+    root.nodeId = ROOT_ID;
+    root.root = true;
+    mesh.tree.subs.push_back(root);
+    for (int i = 0; i < leaves; i++) {
+        painlessmesh::protocol::NodeTree leaf;
+        leaf.nodeId = 100u + i;
+        mesh.tree.subs.push_back(leaf);
+    }
+}
+
+static DataPacket reading(int i) {
+    return DataPacket{123456789ULL + i, 400 + i, 0};
+}
+
+// Sin agregación: cada lectura de una hoja es un frame DATA reenviado
+static void BM_RelayPerReading(benchmark::State& state) {
+    const int leaves = state.range(0);
+    painlessMesh mesh;
+    buildRelay(mesh, leaves);
+    SyncManager sync(&mesh);
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        for (int i = 0; i < leaves; i++) {
+            mesh.sendSingle(ROOT_ID, sync.createDataJSON(reading(i), "DATA", 100u + i));
+        }
+        mesh.sendSingle(ROOT_ID, sync.createDataJSON(reading(leaves), "DATA", RELAY_ID));
+    }
+    alloc::report(state, start);
+    state.counters["frames_per_tick"] = (double)mesh.framesSent / state.iterations();
+    state.counters["bytes_per_tick"] = (double)mesh.bytesSent / state.iterations();
+}
+BENCHMARK(BM_RelayPerReading)->Arg(4)->Arg(16)->Arg(24);
+
+// Con agregación: las lecturas del tick salen en frames AGG de hasta AGG_MAX_ENTRIES
+static void BM_RelayAggregated(benchmark::State& state) {
+    const int leaves = state.range(0);
+    painlessMesh mesh;
+    buildRelay(mesh, leaves);
+    RelayAggregator aggregator(&mesh, 500);
+
+    // Fuera del bucle: cada frame debe caber en el documento del ROOT (receivedCallback)
+    int parseErrors = 0;
+    mesh.onSend = [&](uint32_t, const String& msg) {
+        StaticJsonDocument<AGG_DOC_SIZE> doc;
+        if (deserializeJson(doc, msg) || doc["items"].size() == 0) parseErrors++;
+    };
+    for (int i = 0; i < leaves; i++) aggregator.add(100u + i, reading(i));
+    aggregator.add(RELAY_ID, reading(leaves));
+    aggregator.flush(ROOT_ID);
+    mesh.onSend = nullptr;
+    mesh.framesSent = 0;
+    mesh.bytesSent = 0;
+
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        for (int i = 0; i < leaves; i++) aggregator.add(100u + i, reading(i));
+        aggregator.add(RELAY_ID, reading(leaves));
+        aggregator.flush(ROOT_ID);
+    }
+    alloc::report(state, start);
+    state.counters["frames_per_tick"] = (double)mesh.framesSent / state.iterations();
+    state.counters["bytes_per_tick"] = (double)mesh.bytesSent / state.iterations();
+    state.counters["parse_errors"] = parseErrors;
+}
+BENCHMARK(BM_RelayAggregated)->Arg(4)->Arg(16)->Arg(24);
@@ -0,0 +1,79 @@
+// Buffer offline del CHILD durante un corte largo: cobertura frente a memoria.
+// Lectura cada 5 s (taskSensor); incendio de 10 min al 25% del corte.
+//   fifo:   deque acotado que descarta lo más antiguo (comportamiento anterior)
+//   tiered: RetentionBuffer (mín/máx/última + flancos de llama por ventana)
+#include "alloc.hpp"
+#include "RetentionBuffer.hpp"
+#include <deque>
+#include <random>
+#include <vector>
+
+static const unsigned long long SENSOR_MS = 5000;
+static const unsigned long long FIRE_MS = 10ULL * 60ULL * 1000ULL;
+static const unsigned long long START_TS = 3600000ULL;  // Hora de red al caer el ROOT
+
+// Humo de fondo con ruido; rampa hasta 2500 y llama durante el incendio
+static std::vector<DataPacket> outage(unsigned long long durationMs) {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> noise(-8, 8);
+    unsigned long long fireAt = START_TS + durationMs / 4;
+
+    std::vector<DataPacket> out;
+    for (unsigned long long ts = START_TS; ts < START_TS + durationMs; ts += SENSOR_MS) {
+        bool burning = ts >= fireAt && ts < fireAt + FIRE_MS;
+        int humo = 250 + noise(rng);
+        if (burning) humo = 600 + (int)((ts - fireAt) * 1900 / FIRE_MS);
+        out.push_back(DataPacket{ts, constrain(humo, 0, 4095), (uint8_t)burning});
+    }
+    return out;
+}
+
+static void BM_RetentionOutage(benchmark::State& state) {
+    const bool tiered = state.range(0) == 1;
+    const size_t capacity = state.range(1);
+    const unsigned long long durationMs = state.range(2) * 3600000ULL;
+    std::vector<DataPacket> samples = outage(durationMs);
+
+    std::vector<DataPacket> kept;
+    alloc::Snapshot start = alloc::begin();
+    for (auto _ : state) {
+        kept.clear();
+        if (tiered) {
+            RetentionBuffer buffer(capacity);
+            for (const DataPacket& p : samples) buffer.push(p);
+            for (size_t i = 0; i < buffer.size(); i++) kept.push_back(buffer[i]);
+        } else {
+            std::deque<DataPacket> buffer;
+            for (const DataPacket& p : samples) {
+                buffer.push_back(p);
+                if (buffer.size() > capacity) buffer.pop_front();
+            }
+            kept.assign(buffer.begin(), buffer.end());
+        }
+    }
+    alloc::report(state, start);
+
+    // Flancos y pico del evento que sobreviven al corte
+    int edges = 0, peak = 0, truePeak = 0;
+    unsigned long long maxGap = 0;
+    for (size_t i = 0; i < kept.size(); i++) {
+        if (i > 0 && kept[i].fuego != kept[i - 1].fuego) edges++;
+        if (i > 0 && kept[i].timestamp - kept[i - 1].timestamp > maxGap) {
+            maxGap = kept[i].timestamp - kept[i - 1].timestamp;
+        }
+        peak = max(peak, kept[i].humo);
+    }
+    for (const DataPacket& p : samples) truePeak = max(truePeak, p.humo);
+
+    unsigned long long covered = kept.empty() ? 0 : kept.back().timestamp - kept.front().timestamp;
+    state.counters["buffer_bytes"] = capacity * sizeof(DataPacket);
+    state.counters["coverage_min"] = covered / 60000.0;
+    state.counters["covered_pct"] = 100.0 * covered / (samples.back().timestamp - samples.front().timestamp);
+    state.counters["max_gap_min"] = maxGap / 60000.0;
+    state.counters["fire_edges"] = edges;
+    state.counters["peak_kept"] = peak == truePeak;
+}
+BENCHMARK(BM_RetentionOutage)
+    ->ArgNames({"tiered", "capacity", "hours"})
+    ->ArgsProduct({{0, 1}, {20, 120, 480}, {1, 4, 8, 24}})
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
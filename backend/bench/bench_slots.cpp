@@ -0,0 +1,62 @@
+// Ingesta en el ROOT con N childs sincronizados: ráfaga en el tick (sin slots),
+// jitter aleatorio (respaldo antes de recibir slot) y slots asignados por el ROOT.
+// Modelo de entrega: el ROOT y sus relays absorben a lo sumo CAPACITY frames por
+// ventana de WINDOW_MS; lo que excede se pierde.
+#include "alloc.hpp"
+#include <random>
+#include <vector>
+
+static const unsigned long PERIOD_MS = 5000;  // taskSensor
+static const unsigned long BIN_MS = 100;      // Resolución del pico de ingesta
+static const unsigned long WINDOW_MS = 50;
+static const int CAPACITY = 8;
+static const int TICKS = 720;                 // Una hora de muestreo
+
+enum Scheme { LOCKSTEP = 0, RANDOM_JITTER = 1, SLOTS = 2 };
+
+static void BM_SlotIngest(benchmark::State& state) {
+    const Scheme scheme = (Scheme)state.range(0);
+    const int nodes = state.range(1);
+    double peakToAvg = 0;
+    double delivery = 0;
+
+    for (auto _ : state) {
+        std::mt19937 rng(11);
+        std::normal_distribution<double> syncError(0.0, 10.0);  // Error residual del reloj de red
+        std::uniform_int_distribution<int> processing(0, 20);   // Lectura del ADC + loop
+        std::uniform_int_distribution<int> fallback(0, PERIOD_MS - 1);
+        std::vector<double> offsetMs(nodes);
+        for (int n = 0; n < nodes; n++) offsetMs[n] = syncError(rng);
+
+        std::vector<uint32_t> bins(PERIOD_MS * TICKS / BIN_MS + 2, 0);
+        std::vector<uint32_t> windows(PERIOD_MS * TICKS / WINDOW_MS + 2, 0);
+        uint64_t sent = 0;
+        uint64_t delivered = 0;
+
+        for (int tick = 0; tick < TICKS; tick++) {
+            for (int n = 0; n < nodes; n++) {
+                double at = (double)tick * PERIOD_MS + offsetMs[n] + processing(rng);
+                if (scheme == RANDOM_JITTER) at += fallback(rng);
+                // SyncManager::getSlotOffset: slotIndex * period / slotCount
+                if (scheme == SLOTS) at += (double)((unsigned long long)n * PERIOD_MS / nodes);
+                if (at < 0) at = 0;
+
+                unsigned long ms = (unsigned long)at % (PERIOD_MS * TICKS);
+                bins[ms / BIN_MS]++;
+                sent++;
+                if (windows[ms / WINDOW_MS]++ < CAPACITY) delivered++;
+            }
+        }
+
+        uint32_t peak = 0;
+        for (uint32_t b : bins) peak = b > peak ? b : peak;
+        double avg = (double)sent / (PERIOD_MS * TICKS / BIN_MS);
+        peakToAvg = peak / avg;
+        delivery = (double)delivered / sent;
+    }
+    state.counters["peak_to_avg"] = peakToAvg;
+    state.counters["delivery"] = delivery;
+}
+BENCHMARK(BM_SlotIngest)
+    ->ArgsProduct({{LOCKSTEP, RANDOM_JITTER, SLOTS}, {16, 64, 256}})
+    ->Iterations(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,183 @@
+// Shim de Arduino para compilar el firmware en Linux (solo benchmarks).
+// Cubre lo que usan los módulos enlazados en bench/: String, reloj, Serial
+// y un par de utilidades del core ESP32.
+#ifndef FIREMESH_SHIM_ARDUINO_H
+#define FIREMESH_SHIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ========== RELOJ VIRTUAL ==========
+// Las simulaciones lo avanzan a mano; delay() avanza sin dormir.
+namespace host {
+extern uint64_t clockUs;
+
+inline void setMs(unsigned long long ms) { clockUs = ms * 1000ULL; }
+inline void advanceMs(unsigned long long ms) { clockUs += ms * 1000ULL; }
+inline void advanceUs(unsigned long long us) { clockUs += us; }
+}  // namespace host
+
+inline unsigned long millis() { return (unsigned long)(host::clockUs / 1000ULL); }
+inline unsigned long micros() { return (unsigned long)host::clockUs; }
+inline void delay(unsigned long ms) { host::advanceMs(ms); }
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// ========== STRING ==========
+class String {
+protected:
+    std::string s;
+
+public:
+    String() {}
+    String(const char* cstr) : s(cstr ? cstr : "") {}
+    String(const std::string& str) : s(str) {}
+    String(const String& other) = default;
+    String(String&& other) = default;
+    explicit String(char c) : s(1, c) {}
+    explicit String(int value) : s(std::to_string(value)) {}
+    explicit String(unsigned int value) : s(std::to_string(value)) {}
+    explicit String(long value) : s(std::to_string(value)) {}
+    explicit String(unsigned long value) : s(std::to_string(value)) {}
+    explicit String(long long value) : s(std::to_string(value)) {}
+    explicit String(unsigned long long value) : s(std::to_string(value)) {}
+    explicit String(double value, unsigned int decimals = 2) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+        s = buf;
+    }
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) = default;
+    String& operator=(const char* cstr) { s = cstr ? cstr : ""; return *this; }
+
+    unsigned char reserve(unsigned int size) { s.reserve(size); return 1; }
+    unsigned int length() const { return (unsigned int)s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    const char* c_str() const { return s.c_str(); }
+    char operator[](unsigned int index) const { return index < s.size() ? s[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    unsigned char concat(const String& str) { s += str.s; return 1; }
+    unsigned char concat(const char* cstr) { if (!cstr) return 0; s += cstr; return 1; }
+    unsigned char concat(char c) { s += c; return 1; }
+    unsigned char concat(int v) { s += std::to_string(v); return 1; }
+    unsigned char concat(unsigned int v) { s += std::to_string(v); return 1; }
+    unsigned char concat(long v) { s += std::to_string(v); return 1; }
+    unsigned char concat(unsigned long v) { s += std::to_string(v); return 1; }
+    unsigned char concat(long long v) { s += std::to_string(v); return 1; }
+    unsigned char concat(unsigned long long v) { s += std::to_string(v); return 1; }
+    unsigned char concat(double v) { return concat(String(v)); }
+
+    template <typename T>
+    String& operator+=(const T& value) { concat(value); return *this; }
+
+    bool equals(const String& other) const { return s == other.s; }
+    bool equals(const char* cstr) const { return s == (cstr ? cstr : ""); }
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool operator<(const String& other) const { return s < other.s; }
+
+    bool startsWith(const String& prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String& suffix) const {
+        return s.size() >= suffix.s.size() &&
+               s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = s.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const String& str, unsigned int from = 0) const {
+        size_t pos = s.find(str.s, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= s.size() || to <= from) return String();
+        return String(s.substr(from, to - from));
+    }
+    long toInt() const { return atol(s.c_str()); }
+};
+
+// Resultado de operator+ (ArduinoJson lo reconoce como String)
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& str) : String(str) {}
+    StringSumHelper(const char* cstr) : String(cstr) {}
+};
+
+template <typename T>
+inline StringSumHelper operator+(const String& lhs, const T& rhs) {
+    StringSumHelper out(lhs);
+    out.concat(rhs);
+    return out;
+}
+
+// ========== SERIAL ==========
+// Sin salida: los benchmarks no deben medir la UART. Con host::uart.baud > 0
+// se modela la FIFO de TX sobre el reloj virtual: lo que no cabe bloquea (avanza
+// el reloj) hasta que la UART lo vacía, como Serial.write en el ESP32.
+namespace host {
+struct UartModel {
+    unsigned long baud = 0;   // 0 = sin modelo
+    size_t fifo = 128;        // FIFO de TX del ESP32 (sin buffer de software)
+    double level = 0;         // Bytes en la FIFO
+    uint64_t lastUs = 0;
+    uint64_t bytes = 0;
+    uint64_t blockedUs = 0;   // Tiempo bloqueado esperando hueco
+};
+extern UartModel uart;
+}  // namespace host
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    template <typename T> size_t print(const T&) { return 0; }
+    template <typename T> size_t println(const T&) { return 0; }
+    size_t println() { return write((const uint8_t*)"\r\n", 2); }
+    int printf(const char* fmt, ...);
+    int availableForWrite();
+    size_t write(const uint8_t* data, size_t len);
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() {}
+};
+
+extern HostSerial Serial;
+
+// ========== CORE ESP32 ==========
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason();
+
+#endif
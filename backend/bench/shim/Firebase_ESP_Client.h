@@ -0,0 +1,137 @@
+#ifndef FIREMESH_SHIM_FIREBASE_ESP_CLIENT_H
+#define FIREMESH_SHIM_FIREBASE_ESP_CLIENT_H
+
+#include <Arduino.h>
+#include <utility>
+#include <vector>
+
+// Cliente de Firebase sustituido por uno sin red: cada petición RTDB cuenta
+// y avanza el reloj virtual lo que tarde (host::firebase.requestMs), así las
+// simulaciones reproducen el pushJSON bloqueante sin medir HTTPS/TLS.
+
+struct TokenInfo {
+    int status;
+};
+typedef void (*TokenStatusCallback)(TokenInfo);
+
+struct FirebaseAuth {
+    struct {
+        String email;
+        String password;
+    } user;
+};
+
+struct FirebaseConfig {
+    String api_key;
+    String database_url;
+    TokenStatusCallback token_status_callback = nullptr;
+    struct {
+        unsigned long serverResponse = 0;
+        unsigned long socketConnection = 0;
+    } timeout;
+};
+
+// Documento plano ruta -> valor ya serializado
+class FirebaseJson {
+private:
+    std::vector<std::pair<String, String>> items;
+
+    void put(const String& path, const String& value) {
+        for (auto& item : items) {
+            if (item.first == path) {
+                item.second = value;
+                return;
+            }
+        }
+        items.emplace_back(path, value);
+    }
+
+public:
+    void set(const String& path, int value) { put(path, String(value)); }
+    void set(const String& path, double value) { put(path, String(value, 6)); }
+    void set(const String& path, bool value) { put(path, value ? "true" : "false"); }
+    void set(const String& path, const char* value) { put(path, String("\"") + value + "\""); }
+    void set(const String& path, const String& value) { set(path, value.c_str()); }
+    void setJsonData(const String& json) { put("", json); }
+    void clear() { items.clear(); }
+
+    void toString(String& out, bool prettify = false) const {
+        (void)prettify;
+        out = "{";
+        for (size_t i = 0; i < items.size(); i++) {
+            if (i > 0) out += ',';
+            out += '"';
+            out += items[i].first;
+            out += "\":";
+            out += items[i].second;
+        }
+        out += '}';
+    }
+};
+
+class FirebaseData {
+public:
+    String error;
+    String json;
+    String path = "/";
+    String type = "json";
+    bool available = false;
+    String push;  // Clave del último pushJSON
+
+    String errorReason() { return error; }
+    bool streamAvailable() { bool was = available; available = false; return was; }
+    String dataPath() { return path; }
+    String dataType() { return type; }
+    String jsonString() { return json; }
+    String pushName() { return push; }
+};
+
+namespace host {
+struct FirebaseStats {
+    unsigned long requestMs = 0;  // Latencia simulada por petición
+    bool fail = false;
+    uint32_t requests = 0;
+    uint64_t payloadBytes = 0;
+    String lastPath;
+    String lastBody;
+};
+extern FirebaseStats firebase;
+}  // namespace host
+
+class FirebaseRTDB {
+private:
+    bool request(FirebaseData* fbdo, const String& path, FirebaseJson* json) {
+        host::firebase.requests++;
+        host::firebase.lastPath = path;
+        host::firebase.lastBody = "";
+        if (json) {
+            json->toString(host::firebase.lastBody);
+            host::firebase.payloadBytes += host::firebase.lastBody.length();
+        }
+        host::advanceMs(host::firebase.requestMs);
+        fbdo->push = "-K" + String(host::firebase.requests);
+        if (host::firebase.fail) fbdo->error = "connection refused";
+        return !host::firebase.fail;
+    }
+
+public:
+    bool pushJSON(FirebaseData* fbdo, const String& path, FirebaseJson* json) { return request(fbdo, path, json); }
+    bool setJSON(FirebaseData* fbdo, const String& path, FirebaseJson* json) { return request(fbdo, path, json); }
+    bool updateNode(FirebaseData* fbdo, const String& path, FirebaseJson* json) { return request(fbdo, path, json); }
+    bool getJSON(FirebaseData* fbdo, const String& path) { return request(fbdo, path, nullptr); }
+    bool beginStream(FirebaseData* fbdo, const String& path) { return request(fbdo, path, nullptr); }
+    bool readStream(FirebaseData* fbdo) { (void)fbdo; return true; }
+};
+
+class FirebaseClient {
+public:
+    FirebaseRTDB RTDB;
+
+    void begin(FirebaseConfig* config, FirebaseAuth* auth) { (void)config; (void)auth; }
+    void reconnectWiFi(bool reconnect) { (void)reconnect; }
+    bool ready() { return true; }
+};
+
+extern FirebaseClient Firebase;
+
+#endif
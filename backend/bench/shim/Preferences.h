@@ -0,0 +1,52 @@
+#ifndef FIREMESH_SHIM_PREFERENCES_H
+#define FIREMESH_SHIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+// NVS en memoria: un mapa por espacio de nombres, compartido por el proceso
+class Preferences {
+private:
+    typedef std::map<std::string, std::vector<uint8_t>> Space;
+    Space* space = nullptr;
+
+    static std::map<std::string, Space>& store() {
+        static std::map<std::string, Space> nvs;
+        return nvs;
+    }
+
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        (void)readOnly;
+        space = &store()[name];
+        return true;
+    }
+    void end() { space = nullptr; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        const uint8_t* bytes = (const uint8_t*)value;
+        (*space)[key].assign(bytes, bytes + len);
+        return len;
+    }
+    size_t getBytesLength(const char* key) {
+        auto it = space->find(key);
+        return it == space->end() ? 0 : it->second.size();
+    }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        auto it = space->find(key);
+        if (it == space->end() || it->second.size() > maxLen) return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+        uint32_t value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+    size_t putUInt(const char* key, uint32_t value) {
+        return putBytes(key, &value, sizeof(value));
+    }
+};
+
+#endif
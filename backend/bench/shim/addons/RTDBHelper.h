@@ -0,0 +1,6 @@
+#ifndef FIREMESH_SHIM_RTDB_HELPER_H
+#define FIREMESH_SHIM_RTDB_HELPER_H
+
+#include <Firebase_ESP_Client.h>
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef FIREMESH_SHIM_TOKEN_HELPER_H
+#define FIREMESH_SHIM_TOKEN_HELPER_H
+
+#include <Firebase_ESP_Client.h>
+
+inline void tokenStatusCallback(TokenInfo info) { (void)info; }
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef FIREMESH_SHIM_ESP32_RTC_H
+#define FIREMESH_SHIM_ESP32_RTC_H
+
+#include <Arduino.h>
+
+// El contador RTC sigue al reloj virtual
+inline uint64_t esp_rtc_get_time_us() { return host::clockUs; }
+
+#endif
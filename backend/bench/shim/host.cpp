@@ -0,0 +1,78 @@
+#include <Arduino.h>
+#include <Firebase_ESP_Client.h>
+#include <random>
+#include <stdarg.h>
+
+namespace host {
+uint64_t clockUs = 0;
+FirebaseStats firebase;
+UartModel uart;
+}  // namespace host
+
+HostSerial Serial;
+
+// La FIFO se vacía a baud/10 bytes por segundo (8N1) desde la última consulta
+static void uartDrain() {
+    host::UartModel& u = host::uart;
+    double sent = (double)(host::clockUs - u.lastUs) * u.baud / 10.0 / 1e6;
+    u.level = sent >= u.level ? 0 : u.level - sent;
+    u.lastUs = host::clockUs;
+}
+
+int HostSerial::availableForWrite() {
+    if (host::uart.baud == 0) return 4096;
+    uartDrain();
+    return (int)(host::uart.fifo - (size_t)ceil(host::uart.level));
+}
+
+size_t HostSerial::write(const uint8_t* data, size_t len) {
+    (void)data;
+    host::UartModel& u = host::uart;
+    if (u.baud == 0) return len;
+
+    uartDrain();
+    double room = u.fifo - u.level;
+    if (len > room) {
+        // Bloqueo hasta que salga lo que no cabe
+        uint64_t waitUs = (uint64_t)ceil((len - room) * 10.0 * 1e6 / u.baud);
+        host::advanceUs(waitUs);
+        u.blockedUs += waitUs;
+        uartDrain();
+    }
+    u.level = std::min((double)u.fifo, u.level + len);
+    u.bytes += len;
+    return len;
+}
+
+// Formatea siempre (el coste de CPU de un log directo es el vsnprintf)
+int HostSerial::printf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n <= 0) return n;
+    return (int)write((const uint8_t*)buf, std::min((size_t)n, sizeof(buf) - 1));
+}
+FirebaseClient Firebase;
+
+// Semilla fija: las simulaciones son reproducibles entre commits
+static std::mt19937 rng(12345);
+
+void randomSeed(unsigned long seed) {
+    rng.seed(seed);
+}
+
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    return (long)(rng() % (unsigned long)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+esp_reset_reason_t esp_reset_reason() {
+    return ESP_RST_SW;
+}
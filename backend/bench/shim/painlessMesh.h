@@ -0,0 +1,55 @@
+#ifndef FIREMESH_SHIM_PAINLESSMESH_H
+#define FIREMESH_SHIM_PAINLESSMESH_H
+
+#include <Arduino.h>
+#include <functional>
+#include <list>
+
+// painlessMesh mínimo: identidad, topología fija y un gancho de envío para
+// que las simulaciones enruten los mensajes entre instancias.
+namespace painlessmesh {
+namespace protocol {
+struct NodeTree {
+    uint32_t nodeId = 0;
+    bool root = false;
+    std::list<NodeTree> subs;
+};
+}  // namespace protocol
+}  // namespace painlessmesh
+
+class painlessMesh {
+public:
+    uint32_t nodeId = 1;
+    std::list<uint32_t> nodes;
+    painlessmesh::protocol::NodeTree tree;
+
+    // Destino 0 = broadcast
+    std::function<void(uint32_t dest, const String& msg)> onSend;
+    uint32_t framesSent = 0;
+    uint64_t bytesSent = 0;
+
+    uint32_t getNodeId() { return nodeId; }
+    std::list<uint32_t> getNodeList(bool includeSelf = false) {
+        std::list<uint32_t> out = nodes;
+        if (includeSelf) out.push_back(nodeId);
+        return out;
+    }
+    painlessmesh::protocol::NodeTree asNodeTree() {
+        painlessmesh::protocol::NodeTree out = tree;
+        out.nodeId = nodeId;
+        return out;
+    }
+
+    bool sendSingle(uint32_t dest, String msg) {
+        framesSent++;
+        bytesSent += msg.length();
+        if (onSend) onSend(dest, msg);
+        return true;
+    }
+    bool sendBroadcast(String msg, bool includeSelf = false) {
+        (void)includeSelf;
+        return sendSingle(0, msg);
+    }
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef FIREMESH_SHIM_ROM_CRC_H
+#define FIREMESH_SHIM_ROM_CRC_H
+
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3) equivalente a crc32_le de la ROM del ESP32
+inline uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+#endif
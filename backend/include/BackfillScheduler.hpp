@@ -0,0 +1,43 @@
+#ifndef BACKFILL_SCHEDULER_H
+#define BACKFILL_SCHEDULER_H
+
+#include <Arduino.h>
+#include <map>
+
+struct BackfillRequest {
+    uint32_t pending;             // Lecturas en buffer anunciadas por el child
+    unsigned long firstRequestMs; // Inicio de la recuperación de este nodo
+    unsigned long grantedMs;      // Última concesión (0 = nunca)
+    bool active;
+};
+
+// El ROOT reparte ventanas de backfill (GRANT) a los childs que anuncian
+// historial (BUF), con concurrencia acotada y en turno rotatorio.
+class BackfillScheduler {
+private:
+    std::map<uint32_t, BackfillRequest> requests;
+    int maxConcurrent;
+    int blocksPerGrant;
+    unsigned long grantTimeoutMs;
+
+    uint32_t grantsIssued;
+    uint32_t recoveriesCompleted;
+    unsigned long lastRecoveryMs;
+
+public:
+    BackfillScheduler(int maxConcurrent = 1, int blocksPerGrant = 4,
+                      unsigned long grantTimeoutMs = 10000);
+
+    void onAdvertise(uint32_t nodeId, uint32_t pending, bool windowEnd, unsigned long now);
+    bool nextGrant(uint32_t& nodeId, unsigned long now);
+    void forget(uint32_t nodeId);
+
+    bool isRecovering();
+    size_t waitingCount();
+    int getBlocksPerGrant();
+    uint32_t getGrantsIssued();
+    uint32_t getRecoveriesCompleted();
+    unsigned long getLastRecoveryMs();
+};
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef DATA_PACKET_H
+#define DATA_PACKET_H
+
+#include <Arduino.h>
+
+// Estructura de datos según protocolo
+struct DataPacket {
+    unsigned long long timestamp;
+    int humo;
+    uint8_t fuego;
+    uint8_t tier = 0;  // Compactaciones sufridas en el buffer (0 = lectura original)
+};
+
+#endif
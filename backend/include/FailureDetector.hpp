@@ -0,0 +1,32 @@
+#ifndef FAILURE_DETECTOR_H
+#define FAILURE_DETECTOR_H
+
+#include <Arduino.h>
+
+#define FD_WINDOW 32
+
+// Detector phi-accrual: la sospecha crece con el silencio en función de la
+// distribución observada de intervalos entre heartbeats.
+class FailureDetector {
+private:
+    unsigned long intervals[FD_WINDOW];
+    int count;
+    int next;
+    unsigned long lastHeartbeat;
+    double phiThreshold;
+    unsigned long minStdDevMs;
+    unsigned long maxSilenceMs;
+
+public:
+    FailureDetector(double phiThreshold = 8.0, unsigned long maxSilenceMs = 2000,
+                    unsigned long minStdDevMs = 50);
+
+    void reset();
+    void heartbeat(unsigned long now);
+    double phi(unsigned long now);
+    bool isSuspected(unsigned long now);
+    unsigned long silence(unsigned long now);
+    bool hasHeartbeat();
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef FIRE_DETECTOR_H
+#define FIRE_DETECTOR_H
+
+#include <Arduino.h>
+#include <unordered_map>
+
+// Eventos derivados que emite el detector
+enum FireEventType {
+    EVENT_RATE_OF_RISE   = 1,   // Pendiente de humo sostenida
+    EVENT_CHANGE_POINT   = 2,   // CUSUM detectó cambio de nivel
+    EVENT_FLAME_CONFIRMED = 4,  // Llama + evidencia de humo
+    EVENT_FLAME_UNCONFIRMED = 8 // Llama sin evidencia de humo (posible falso positivo)
+};
+
+struct FireEvent {
+    uint32_t nodeId;
+    FireEventType type;
+    unsigned long long ts;
+    int humo;
+    double slope;   // unidades de humo por segundo
+    double cusum;
+};
+
+// Parámetros de los detectores (valores en unidades del ADC de humo)
+struct FireDetectorConfig {
+    double meanAlpha = 0.3;        // EWMA del nivel
+    double slopeAlpha = 0.3;       // EWMA de la pendiente
+    double baselineAlpha = 0.02;   // Línea base lenta para CUSUM
+    double slopeThreshold = 5.0;   // unidades/s para rate-of-rise
+    double cusumDrift = 20.0;      // k: holgura antes de acumular
+    double cusumThreshold = 150.0; // h: umbral de alarma
+    int smokeEvidence = 300;       // nivel que acompaña a una llama real
+};
+
+// Estado O(1) por nodo
+struct DetectorState {
+    bool initialized;
+    bool networkTime;   // Base de lastTs: hora de red o llegada al ROOT
+    unsigned long long lastTs;
+    double mean;
+    double baseline;
+    double slope;
+    double cusum;
+    uint8_t activeEvents;
+};
+
+class FireDetector {
+private:
+    std::unordered_map<uint32_t, DetectorState> states;
+    FireDetectorConfig config;
+    void (*eventCallback)(const FireEvent&);
+
+    void raise(DetectorState& st, FireEventType type, bool active, uint32_t nodeId,
+               unsigned long long ts, int humo);
+
+public:
+    FireDetector(FireDetectorConfig cfg = FireDetectorConfig());
+
+    void onEvent(void (*callback)(const FireEvent&));
+    void update(uint32_t nodeId, unsigned long long ts, int humo, int fuego, bool networkTime = true);
+    void forget(uint32_t nodeId);
+    bool isAlerting(uint32_t nodeId);
+    size_t trackedNodes();
+
+    static const char* eventName(FireEventType type);
+};
+
+#endif
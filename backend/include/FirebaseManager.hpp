@@ -3,22 +3,114 @@
 
 #include <Arduino.h>
 #include <Firebase_ESP_Client.h>
+#include <deque>
+#include <map>
+
+// Lectura recibida por la malla pendiente de subir
+struct PendingUpload {
+    unsigned long long ts;
+    uint32_t nodeId;
+    int humo;
+    int fuego;
+    char tipo[12];
+    bool critical;  // Fuego o humo crítico: nunca se descarta por cola llena
+};
+
+// Bloque comprimido de historial pendiente de subir
+struct PendingBlock {
+    unsigned long long t0;
+    unsigned long long t1;
+    uint32_t nodeId;
+    int count;
+    String blk;
+};
+
+// Evento de los detectores pendiente de subir
+struct PendingAlert {
+    unsigned long long ts;
+    uint32_t nodeId;
+    int humo;
+    double slope;
+    double cusum;
+    const char* evento;  // FireDetector::eventName (estático)
+};
+
+// Snapshot de flota de un tick (JSON ya serializado)
+struct PendingSnapshot {
+    unsigned long long ts;
+    bool late;
+    bool critical;
+    String json;
+};
+
+// Clave push de los últimos snapshots subidos: las lecturas tardías se
+// fusionan en el mismo registro (ts es millis() del ROOT y se repite tras reiniciar)
+#define SNAPSHOT_KEY_MEMORY 8
+
+struct SnapshotKey {
+    unsigned long long ts = 0;
+    String key;
+};
 
 class FirebaseManager {
 private:
     FirebaseData fbdo;
+    FirebaseData stream;
+    String configPath;
+    bool streaming;
     FirebaseAuth auth;
     FirebaseConfig config;
     bool ready;
 
+    // Cola de ingesta: desacopla la recepción mesh de pushJSON (bloqueante)
+    std::deque<PendingUpload> uploadQueue;
+    std::deque<PendingBlock> blockQueue;
+    std::deque<PendingSnapshot> snapshotQueue;
+    SnapshotKey snapshotKeys[SNAPSHOT_KEY_MEMORY];
+    int snapshotKeyNext;
+    std::deque<PendingAlert> alertQueue;
+    size_t maxQueueSize;
+    size_t maxAlerts;
+    uint32_t droppedUploads;
+
+    // Último estado por nodo: se sobrescribe, solo se sube el más reciente
+    std::map<uint32_t, String> pendingStatus;
+
+    bool evictForCritical();
+
 public:
-    FirebaseManager();
+    FirebaseManager(size_t maxQueue = 64, size_t maxAlerts = 16);
     ~FirebaseManager();
 
     bool begin(const char* apiKey, const char* dbURL, const char* email, const char* password);
     bool isReady();
-    bool sendData(int humo, int fuego, unsigned long long ts, String tipo, uint32_t nodeId);
+    bool sendData(int humo, int fuego, unsigned long long ts, const char* tipo, uint32_t nodeId);
+    bool sendAlert(const PendingAlert& alert);
     void reconnect();
+    bool sendBlock(const PendingBlock& block);
+    bool sendSnapshot(const PendingSnapshot& snapshot);
+    void rememberSnapshotKey(unsigned long long ts);
+    bool sendStatus(uint32_t nodeId, const String& statusJson);
+    void enqueueStatus(uint32_t nodeId, const String& statusJson);
+    bool updatePresence(FirebaseJson& delta);
+
+    // Plano de control: escucha de la ruta de configuración
+    bool beginConfigStream(const char* path);
+    bool isStreaming() const { return streaming; }
+    bool pollConfig(String& json);
+
+    // Backpressure
+    bool enqueueData(int humo, int fuego, unsigned long long ts, const char* tipo, uint32_t nodeId,
+                     bool critical = false);
+    bool enqueueBlock(uint32_t nodeId, unsigned long long t0, unsigned long long t1,
+                      int count, const char* blk);
+    bool enqueueSnapshot(unsigned long long ts, bool late, const String& json, bool critical = false);
+    bool enqueueAlert(const char* evento, int humo, double slope, double cusum,
+                      unsigned long long ts, uint32_t nodeId);
+    int processQueue(int maxItems);
+    size_t getBacklog();
+    uint8_t getCongestionLevel();
+    uint32_t getDroppedUploads();
 };
 
 #endif
@@ -0,0 +1,42 @@
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <Arduino.h>
+#include <vector>
+#include "DataPacket.hpp"
+
+// Bloque comprimido estilo Gorilla para el backfill DATA_HIST:
+//   - ts[0] va fuera del bloque (t0); el resto como delta-of-delta
+//   - humo[0] en 16 bits; el resto como delta con prefijos de longitud
+//   - fuego en 1 bit por muestra
+// El formato se decodifica en frontend/lib/historyCodec.ts.
+class HistoryEncoder {
+private:
+    std::vector<uint8_t> bytes;
+    uint8_t bitPos;
+    size_t maxSamples;
+    size_t samples;
+
+    unsigned long long firstTs;
+    unsigned long long lastTs;
+    long long lastDelta;
+    int lastHumo;
+
+    void writeBits(uint32_t value, uint8_t bits);
+    void writeTimestamp(long long dod);
+    void writeValue(int delta);
+
+public:
+    HistoryEncoder(size_t maxSamples = 64);
+
+    void reset();
+    bool add(const DataPacket& data);
+    bool isFull();
+    size_t count();
+    unsigned long long getFirstTs();
+    unsigned long long getLastTs();
+    size_t encodedSize();
+    String toBase64();
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// Niveles de log (filtrado en compilación con -DLOG_LEVEL=<n>)
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Registros en el ring buffer (potencia de 2)
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 64
+#endif
+
+#define LOG_MAX_ARGS 4
+#define LOG_STR_LEN  24
+
+// Registro binario: el formato no se procesa hasta el drenado
+struct LogRecord {
+    uint32_t ms;
+    const char* fmt;          // Literal en flash, nunca se copia
+    uint8_t level;
+    uint8_t argc;
+    char str[LOG_STR_LEN];    // Copia del único argumento %s permitido
+    uint64_t args[LOG_MAX_ARGS];
+};
+
+namespace Log {
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+
+bool reserve(LogRecord*& rec, uint8_t level, const char* fmt);
+void commit();
+void drain(int maxRecords = 4);
+uint32_t getDropped();
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+packArg(LogRecord& rec, T value) {
+    rec.args[rec.argc++] = (uint64_t)(int64_t)value;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+packArg(LogRecord& rec, T value) {
+    double d = value;
+    memcpy(&rec.args[rec.argc++], &d, sizeof(d));
+}
+
+inline void packArg(LogRecord& rec, const char* value) {
+    strncpy(rec.str, value ? value : "(null)", LOG_STR_LEN - 1);
+    rec.str[LOG_STR_LEN - 1] = '\0';
+    rec.args[rec.argc++] = 0;
+}
+
+inline void packArgs(LogRecord&) {}
+
+template <typename T, typename... Rest>
+inline void packArgs(LogRecord& rec, T value, Rest... rest) {
+    static_assert(sizeof...(Rest) < LOG_MAX_ARGS, "Demasiados argumentos de log");
+    packArg(rec, value);
+    packArgs(rec, rest...);
+}
+
+// Cuenta los argumentos de texto: el registro solo guarda una cadena
+template <typename... Args>
+struct StringArgs { static const int count = 0; };
+
+template <typename T, typename... Rest>
+struct StringArgs<T, Rest...> {
+    static const int count = (std::is_same<typename std::decay<T>::type, const char*>::value ||
+                              std::is_same<typename std::decay<T>::type, char*>::value) +
+                             StringArgs<Rest...>::count;
+};
+
+template <typename... Args>
+inline void write(uint8_t level, const char* fmt, Args... args) {
+    static_assert(StringArgs<Args...>::count <= 1, "Solo se permite un argumento %s por log");
+    LogRecord* rec;
+    if (!reserve(rec, level, fmt)) return;
+    packArgs(*rec, args...);
+    commit();
+}
+
+#else
+
+inline void drain(int = 4) {}
+inline uint32_t getDropped() { return 0; }
+
+#endif
+
+#ifdef LOG_LOOP_STATS
+void measureLoop();
+#else
+inline void measureLoop() {}
+#endif
+
+}  // namespace Log
+
+// -DLOG_INLINE vuelve al Serial.printf directo (referencia para medir jitter)
+#ifdef LOG_INLINE
+#define LOG_EMIT(level, fmt, ...) do { Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); } while (0)
+#else
+#define LOG_EMIT(level, fmt, ...) Log::write(level, fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) LOG_EMIT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) LOG_EMIT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) LOG_EMIT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) LOG_EMIT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define MEM_MAX_TASKS 4
+
+struct MemorySnapshot {
+    uint32_t freeHeap;
+    uint32_t largestBlock;   // Fragmentación: bloque contiguo más grande
+    uint32_t minFreeHeap;    // Mínimo histórico desde el arranque
+};
+
+class MemoryMonitor {
+private:
+    TaskHandle_t tasks[MEM_MAX_TASKS];
+    const char* taskNames[MEM_MAX_TASKS];
+    int taskCount;
+
+public:
+    MemoryMonitor();
+
+    bool registerTask(const char* name, TaskHandle_t handle);
+    bool registerTask(const char* name);
+    MemorySnapshot sample();
+    void fillJson(JsonObject obj);
+    void log();
+};
+
+#endif
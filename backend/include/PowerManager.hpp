@@ -0,0 +1,77 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Sueño de nodo aislado del CHILD (-DCHILD_ISOLATED_SLEEP=1). El ahorro real
+// está solo en el nodo sin vecinos: ahí entra en sueño ligero hasta el próximo
+// deadline, salvo durante la ventana de unión (radio despierta para encontrar
+// la malla), que se reabre cada joinRetryMs.
+// Con vecinos, el AP de painlessMesh retiene el lock de WiFi y no hay sueño
+// ligero posible (ni el automático de esp_pm ni el manual): el loop solo se
+// bloquea, acotado para no retrasar la malla, a 80 MHz y con el módem en
+// power-save. La entrada de fuego despierta al nodo en cualquier caso, con
+// como mucho una lectura forzada por fireWakeGapMs.
+
+struct PowerStats {
+    uint32_t windowMs;
+    uint32_t dutyPermille;       // Tiempo de CPU fuera de idle() por mil
+    uint32_t readings;
+    uint32_t activeUsPerReading; // CPU activa por lectura
+    uint32_t lightSleeps;
+    uint32_t fireWakes;
+    uint32_t fireWakesIgnored;   // Flancos dentro de fireWakeGapMs (rebote)
+    uint32_t wakeToSendUs;       // Último flanco de fuego → lectura enviada
+    uint32_t wakeToSendMaxUs;
+};
+
+class PowerManager {
+private:
+    bool enabled;
+    unsigned long idleMaxMs;        // Cota con vecinos: latencia añadida a la malla
+    unsigned long lightSleepMinMs;  // Por debajo no compensa el sueño ligero
+    unsigned long joinWindowMs;     // Aislado: radio despierta antes de dormir
+    unsigned long joinRetryMs;
+    unsigned long fireWakeGapMs;
+    uint8_t firePin;
+
+    bool wasIsolated;
+    unsigned long joinWindowStartMs;
+    bool hasFireWake;
+    unsigned long lastFireWakeMs;
+
+    int64_t windowStartUs;
+    uint64_t sleptUs;
+    uint32_t readings;
+    uint32_t lightSleeps;
+    uint32_t fireWakes;
+    uint32_t fireWakesIgnored;
+
+    uint32_t wakeStartUs;
+    bool wakePending;       // Flanco visto, lectura forzada pendiente
+    bool measuring;         // Lectura del flanco aún sin enviar
+    uint32_t wakeToSendUs;
+    uint32_t wakeToSendMaxUs;
+
+    void lightSleep(unsigned long ms);
+
+public:
+    PowerManager(bool enabled, unsigned long idleMaxMs, unsigned long lightSleepMinMs,
+                 unsigned long joinWindowMs, unsigned long joinRetryMs, unsigned long fireWakeGapMs);
+
+    void begin(uint8_t firePin, uint32_t cpuMhz);
+    void idle(long nextDeadlineMs, bool isolated);
+
+    bool takeFireWake();
+    void onReading();
+    void onSent();
+
+    bool isEnabled() const { return enabled; }
+
+    PowerStats closeWindow();
+    void fillJson(JsonObject obj, const PowerStats& stats);
+    void log(const PowerStats& stats);
+};
+
+#endif
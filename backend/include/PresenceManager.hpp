@@ -0,0 +1,40 @@
+#ifndef PRESENCE_MANAGER_H
+#define PRESENCE_MANAGER_H
+
+#include <painlessMesh.h>
+#include <map>
+
+class FirebaseJson;
+
+struct PresenceEntry {
+    bool online;
+    uint8_t hops;
+    uint16_t linkChanges;
+    unsigned long lastSeen;       // millis() del ROOT
+    unsigned long lastPublished;  // millis() de la última subida de lastSeen
+    bool dirty;
+};
+
+// Tabla de presencia autoritativa del ROOT: solo se publican los cambios
+class PresenceManager {
+private:
+    painlessMesh* mesh;
+    std::map<uint32_t, PresenceEntry> table;
+    unsigned long lastSeenRefreshMs;
+    void (*offlineCallback)(uint32_t nodeId);
+
+    static int depthOf(const painlessmesh::protocol::NodeTree& tree, uint32_t nodeId, int depth);
+
+public:
+    PresenceManager(painlessMesh* meshInstance, unsigned long lastSeenRefreshMs = 60000);
+
+    void onOffline(void (*callback)(uint32_t nodeId));
+    void markSeen(uint32_t nodeId);
+    void updateTopology();
+    bool hasChanges();
+    bool buildDelta(FirebaseJson& json);
+    void clearChanges();
+    size_t onlineCount();
+};
+
+#endif
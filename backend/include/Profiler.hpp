@@ -0,0 +1,42 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Profiler por muestreo (solo en builds de diagnóstico: -DFIREMESH_PROFILER).
+// Una interrupción de timer guarda el PC interrumpido (del marco que salva el
+// vector de interrupción) y la tarea en un histograma fijo; "prof" lo vuelca
+// por Serial y scripts/profile_report.py lo simboliza contra el firmware.elf.
+
+#ifndef PROF_HZ
+#define PROF_HZ 997        // Primo: no se alinea con el tick de 1 kHz de FreeRTOS
+#endif
+
+#define PROF_SLOTS_BITS 9  // 512 PCs distintos (4 KB)
+#define PROF_MAX_TASKS  8
+
+namespace Profiler {
+
+#ifdef FIREMESH_PROFILER
+
+void begin(uint32_t hz = PROF_HZ);
+void reset();
+void dump(Print& out);
+bool handleCommand(const char* line);
+
+#else
+
+inline void begin(uint32_t = PROF_HZ) {}
+inline void reset() {}
+inline void dump(Print&) {}
+inline bool handleCommand(const char* line) {
+    if (strncmp(line, "prof", 4) != 0) return false;
+    Serial.println("[PROF] Profiler no compilado (usar el entorno *_diag)");
+    return true;
+}
+
+#endif
+
+}  // namespace Profiler
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef RELAY_AGGREGATOR_H
+#define RELAY_AGGREGATOR_H
+
+#include <painlessMesh.h>
+#include <ArduinoJson.h>
+#include <vector>
+#include "SyncManager.hpp"
+
+// Lecturas por frame AGG: el receptor debe poder parsear un frame completo
+#define AGG_MAX_ENTRIES 16
+#define AGG_DOC_SIZE (JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(AGG_MAX_ENTRIES) + \
+                      AGG_MAX_ENTRIES * JSON_ARRAY_SIZE(4) + 64)
+
+// Lectura de un nodo dentro de un frame AGG
+struct AggEntry {
+    uint32_t src;
+    DataPacket data;
+    bool urgent;
+};
+
+class RelayAggregator {
+private:
+    painlessMesh* mesh;
+    std::vector<AggEntry> pending;
+    unsigned long windowMs;
+    size_t maxEntries;
+    unsigned long firstPendingAt;
+
+    // Estadísticas para comparar contra el routing por lectura
+    uint32_t framesSent;
+    uint32_t entriesSent;
+    uint32_t framesMerged;
+
+    static bool treeContains(const painlessmesh::protocol::NodeTree& tree, uint32_t nodeId);
+
+public:
+    RelayAggregator(painlessMesh* meshInstance, unsigned long windowMs = 500,
+                    size_t maxEntries = AGG_MAX_ENTRIES);
+
+    uint32_t nextHopTo(uint32_t dest);
+    bool hasDownstream(uint32_t root);
+
+    void add(uint32_t src, DataPacket data, bool urgent = false);
+    void merge(JsonDocument& doc);
+    bool isDue();
+    bool flush(uint32_t root);
+
+    uint32_t getFramesSent();
+    uint32_t getEntriesSent();
+    uint32_t getFramesMerged();
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef REMOTE_CONFIG_H
+#define REMOTE_CONFIG_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+// Parámetros ajustables en caliente desde Firebase (ruta "config")
+struct NodeConfig {
+    uint32_t version;
+    unsigned long sensorMs;
+    unsigned long syncMs;
+    unsigned long statusMs;
+    int bufferSize;
+    int smokeCritical;
+};
+
+// Plano de control: el ROOT convierte el documento de config en un mensaje
+// CFG versionado; cada child lo aplica si va dirigido a él o a su grupo.
+//   {"v":3,"set":{"sensorMs":10000,"syncMs":20000,"statusMs":60000,
+//                 "buffer":50,"smoke":550},"nodes":[3710082173],"group":"norte"}
+// Claves de "set" ausentes conservan su valor; sin "nodes"/"group" aplica a todos.
+//
+// Como "set" es parcial, el ROOT conserva el historial de CFG (compactado: una
+// clave reescrita para el mismo destino sale del mensaje anterior) y lo reenvía
+// en orden de versión; un nodo que llega tarde lo reproduce y acaba en la misma
+// configuración efectiva que si hubiera recibido cada versión.
+#define CONFIG_HISTORY_MAX 8
+
+struct ConfigMessage {
+    uint32_t version;
+    String target;   // {"nodes":[...],"group":"..."} serializado (vacío = toda la flota)
+    String message;  // CFG completo listo para difundir
+};
+
+class RemoteConfig {
+private:
+    NodeConfig current;
+    String group;
+    std::vector<ConfigMessage> history;
+
+    bool isTargeted(JsonVariantConst doc, uint32_t nodeId);
+    void compact(const String& target, JsonObjectConst set);
+
+public:
+    RemoteConfig(const NodeConfig& defaults, const char* group = "");
+
+    // ROOT: documento de Firebase/Serial -> mensaje CFG para la malla
+    bool load(const String& json, String& message);
+    size_t messageCount();
+    const String& getMessage(size_t index);
+
+    // CHILD: aplicar un CFG recibido (true si cambió la configuración)
+    bool apply(JsonDocument& doc, uint32_t nodeId);
+
+    // CHILD: última configuración aplicada en NVS (sobrevive a reinicios)
+    bool restore();
+    void persist();
+
+    const NodeConfig& get();
+    uint32_t getVersion();
+};
+
+#endif
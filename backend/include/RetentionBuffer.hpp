@@ -0,0 +1,42 @@
+#ifndef RETENTION_BUFFER_H
+#define RETENTION_BUFFER_H
+
+#include <deque>
+#include "DataPacket.hpp"
+
+// Retención escalonada: ventanas de RETENTION_WINDOW lecturas se reducen a
+// mín/máx/última + flancos de llama; cada pasada sube un nivel, hasta el
+// último, que se sigue compactando sobre sí mismo (nunca se pierde el inicio)
+#define RETENTION_WINDOW 8
+#define RETENTION_MAX_TIER 6
+
+// Buffer offline acotado del CHILD: al llenarse degrada lo antiguo antes que perderlo
+class RetentionBuffer {
+private:
+    std::deque<DataPacket> buffer;
+    size_t maxSize;
+    uint32_t compactions;
+
+    bool compact();
+    bool reduceWindow(size_t start, uint8_t tier);
+
+public:
+    RetentionBuffer(size_t maxSize = 20);
+
+    // false si hubo que descartar la lectura más antigua
+    bool push(const DataPacket& data);
+    void setMaxSize(size_t size);
+    size_t getMaxSize() const { return maxSize; }
+
+    // Acceso de vaciado (mismo uso que el deque al que sustituye)
+    bool empty() const { return buffer.empty(); }
+    size_t size() const { return buffer.size(); }
+    const DataPacket& front() const { return buffer.front(); }
+    const DataPacket& operator[](size_t i) const { return buffer[i]; }
+    void pop_front() { buffer.pop_front(); }
+
+    unsigned long long getCoverage() const;
+    uint32_t getCompactions() const { return compactions; }
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SNAPSHOT_ASSEMBLER_H
+#define SNAPSHOT_ASSEMBLER_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define SNAPSHOT_CLOSED_MEMORY 8
+
+struct SnapshotEntry {
+    uint32_t nodeId;
+    int humo;
+    uint8_t fuego;
+};
+
+// Todas las lecturas de un mismo tick global (ts = hora de red del tick)
+struct FleetSnapshot {
+    unsigned long long ts;
+    size_t expected;
+    bool late;  // Lecturas que llegaron tras cerrar el tick: se fusionan
+    std::vector<SnapshotEntry> entries;
+};
+
+typedef void (*SnapshotCallback)(const FleetSnapshot& snapshot);
+
+// El ROOT agrupa las lecturas en vivo por tick y cierra cada snapshot cuando
+// han llegado todos los nodos o vence el plazo (ts + deadline, hora del ROOT).
+// "Todos" son los nodos distintos que reportaron en el último tick cerrado:
+// la lista de la malla incluye relays y nodos sin hora de red.
+class SnapshotAssembler {
+private:
+    std::vector<FleetSnapshot> open;
+    unsigned long long closed[SNAPSHOT_CLOSED_MEMORY];
+    int closedNext;
+    unsigned long deadlineMs;
+    size_t maxOpen;
+    SnapshotCallback callback;
+
+    // Nodos que reportaron en el último tick cerrado (0 = aún sin referencia)
+    unsigned long long lastClosedTs;
+    size_t lastReporters;
+
+    uint32_t closedComplete;
+    uint32_t closedDeadline;
+    uint32_t lateEntries;
+
+    bool wasClosed(unsigned long long ts);
+    void close(size_t index, bool complete);
+
+public:
+    SnapshotAssembler(unsigned long deadlineMs = 6000, size_t maxOpen = 4);
+
+    void onSnapshot(SnapshotCallback cb);
+    void add(uint32_t nodeId, unsigned long long ts, int humo, int fuego);
+    void poll(unsigned long long now);
+
+    uint32_t getClosedComplete();
+    uint32_t getClosedDeadline();
+    uint32_t getLateEntries();
+};
+
+#endif
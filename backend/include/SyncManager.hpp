@@ -4,13 +4,11 @@
 #include <painlessMesh.h>
 #include <ArduinoJson.h>
 #include <deque>
+#include <vector>
+#include "DataPacket.hpp"
+#include "RetentionBuffer.hpp"
 
-// Estructura de datos según protocolo
-struct DataPacket {
-    unsigned long long timestamp;
-    int humo;
-    int fuego;
-};
+class HistoryEncoder;
 
 class SyncManager {
 private:
@@ -18,17 +16,53 @@ private:
     double timeOffset;
     bool isSynchronized;
     uint32_t rootNodeId;
-    std::deque<DataPacket>* offlineBuffer;
-    int maxBufferSize;
+    RetentionBuffer* offlineBuffer;
+
+    // Beacons de tiempo: latencia ROOT -> nodo medida en la última calibración
+    double pathDelay;
+    bool isCalibrated;
+    int beaconsSinceCalibration;
+    int calibrationEvery;
+    double lastBeaconError;
+
+    // Nivel de congestión del ROOT recibido en el último beacon (0-3)
+    uint8_t congestionLevel;
+
+    // Contador de mensajes de sincronización enviados (solo ROOT)
+    uint32_t syncMessagesSent;
+
+    // Slots de transmisión: orden estable asignado por el ROOT
+    std::vector<uint32_t> slotOrder;
+    int slotIndex;
+    int slotCount;
+
+    // Deriva del reloj local frente al ROOT, medida entre calibraciones
+    double driftPpm;
+    unsigned long lastCalibrationMs;
+    double lastCalibrationOffset;
+    bool warmStart;
+
+    void persistRootId(uint32_t id);
 
 public:
-    SyncManager(painlessMesh* meshInstance, int maxBuffer = 20);
+    SyncManager(painlessMesh* meshInstance, int maxBuffer = 20, int calibrationEvery = 6);
     
     // Getters
     double getTimeOffset();
     bool getSyncStatus();
     uint32_t getRootId();
     unsigned long long getNetworkTime();
+    double getPathDelay();
+    double getLastBeaconError();
+    uint32_t takeSyncMessageCount();
+    uint8_t getCongestionLevel();
+    bool hasSlot();
+    unsigned long getTickDelay(unsigned long period);
+    unsigned long getSlotOffset(unsigned long period);
+    unsigned long long snapToTick(unsigned long long ts, unsigned long period, unsigned long tolerance);
+    double getDriftPpm();
+    bool isWarmStart();
+    void setMaxBufferSize(int size);
     
     // Setters
     void setTimeOffset(double offset);
@@ -38,12 +72,29 @@ public:
     // Buffer management
     void addToBuffer(DataPacket data);
     bool hasBufferedData();
+    size_t getBufferedCount();
+    unsigned long long getBufferCoverage();
+    uint32_t getCompactions();
     void flushBuffer(void (*sendCallback)(DataPacket, String));
+    int flushBufferBlocks(void (*sendRaw)(const String&), size_t blockSamples = 64, int maxBlocks = 0);
     
     // Mesh helpers
     String createDataJSON(DataPacket data, String tipo, uint32_t nodeId);
-    void handleSyncRequest(uint32_t from);
+    String createBlockJSON(HistoryEncoder& encoder, uint32_t nodeId);
+
+    // Sincronización: beacon SYNC (ROOT -> todos) + calibración TIME ocasional
+    void updateSlots(const std::list<uint32_t>& nodes);
+    String createSyncBeacon(uint8_t congestion = 0);
+    void handleSyncBeacon(JsonDocument& doc);
+    static size_t docCapacityFor(const String& msg);
+    bool needsCalibration();
+    String createSyncRequest();
+    void handleSyncRequest(uint32_t from, JsonDocument& doc);
     void handleSyncResponse(JsonDocument& doc);
+
+    // Arranque en caliente: ROOT en NVS, hora de red en memoria RTC
+    bool restoreState();
+    void saveState();
 };
 
-#endif
\ No newline at end of file
+#endif
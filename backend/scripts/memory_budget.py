@@ -0,0 +1,73 @@
+"""
+Reporte de RAM estática y flash por entorno PlatformIO.
+
+Se engancha como post-acción del firmware.elf y falla el build si se supera
+el presupuesto configurado en platformio.ini:
+
+    custom_ram_budget   = <bytes>   ; .dram0.data + .dram0.bss (+ .noinit)
+    custom_flash_budget = <bytes>   ; código y datos de solo lectura
+
+Un presupuesto vacío o ausente solo imprime el reporte.
+"""
+
+import re
+import subprocess
+
+Import("env")  # noqa: F821  (inyectado por SCons)
+
+# Mismas secciones que usa PlatformIO para su propio resumen en ESP32
+DEFAULT_PROG_REGEXP = (
+    r"^(?:\.iram0\.text|\.iram0\.vectors|\.dram0\.data|\.flash\.text|"
+    r"\.flash\.rodata|\.flash\.appdesc)\s+([0-9]+).*"
+)
+DEFAULT_DATA_REGEXP = r"^(?:\.dram0\.data|\.dram0\.bss|\.noinit)\s+([0-9]+).*"
+
+
+def _budget(name):
+    value = env.GetProjectOption(name, "").strip()  # noqa: F821
+    return int(value) if value else None
+
+
+def _sum_sections(output, pattern):
+    regexp = re.compile(pattern)
+    total = 0
+    for line in output.splitlines():
+        match = regexp.search(line)
+        if match:
+            total += int(match.group(1))
+    return total
+
+
+def check_memory_budget(target, source, env):
+    elf = str(target[0])
+    size_tool = env.subst("$SIZETOOL") or "xtensa-esp32-elf-size"
+    output = subprocess.check_output([size_tool, "-A", "-d", elf], text=True)
+
+    flash = _sum_sections(output, env.get("SIZEPROGREGEXP") or DEFAULT_PROG_REGEXP)
+    ram = _sum_sections(output, env.get("SIZEDATAREGEXP") or DEFAULT_DATA_REGEXP)
+
+    ram_budget = _budget("custom_ram_budget")
+    flash_budget = _budget("custom_flash_budget")
+    env_name = env["PIOENV"]
+
+    def line(label, used, budget):
+        if budget is None:
+            return "  %-6s %8d bytes (sin presupuesto)" % (label, used)
+        return "  %-6s %8d / %8d bytes (%5.1f%%)" % (label, used, budget, 100.0 * used / budget)
+
+    print("[Memoria] Entorno '%s'" % env_name)
+    print(line("RAM", ram, ram_budget))
+    print(line("Flash", flash, flash_budget))
+
+    over = []
+    if ram_budget is not None and ram > ram_budget:
+        over.append("RAM excede por %d bytes" % (ram - ram_budget))
+    if flash_budget is not None and flash > flash_budget:
+        over.append("Flash excede por %d bytes" % (flash - flash_budget))
+
+    if over:
+        print("[Memoria] ERROR: presupuesto de '%s' superado: %s" % (env_name, "; ".join(over)))
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_memory_budget)  # noqa: F821
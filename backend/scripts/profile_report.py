@@ -0,0 +1,233 @@
+"""
+Reporte del profiler por muestreo (builds root_diag / child_diag).
+
+Lee una captura de Serial con el volcado del comando "prof" y simboliza los
+PCs contra el firmware.elf del entorno:
+
+    python scripts/profile_report.py captura.log --elf .pio/build/root_diag/firmware.elf
+
+Formato del volcado (el resto de líneas de la captura se ignora):
+
+    PROF BEGIN hz=<n> samples=<n> dropped=<n> other=<n> nested=<n> ms=<n>
+    PROF T <tarea> <muestras>
+    PROF P 0x<pc> <muestras>
+    PROF END
+
+Sin toolchain se puede pasar una tabla de símbolos ya generada con
+`xtensa-esp32-elf-nm -n -C -S --defined-only firmware.elf > simbolos.txt`:
+
+    python scripts/profile_report.py captura.log --symbols simbolos.txt
+
+Si la captura contiene varios volcados se usa el último.
+"""
+
+import argparse
+import bisect
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+# Agrupación por subsistema según el nombre (demangled) de la función
+CATEGORIES = [
+    ("json", r"ArduinoJson|deserializeJson|serializeJson|measureJson"),
+    ("tls", r"mbedtls_|\bssl_|esp_tls|WiFiClientSecure"),
+    ("firebase", r"Firebase|FirebaseJson|FB_|RTDB"),
+    ("mesh", r"painlessmesh|painlessMesh|AsyncClient|AsyncTCP|TaskScheduler|Scheduler::"),
+    ("log", r"Log::|vfprintf|_printf|uart_|HardwareSerial"),
+    ("wifi/lwip", r"\blwip_|tcp_|ip4_|pbuf_|esp_wifi|ieee80211|ppTask|wifi_|\bnet80211"),
+    ("heap", r"heap_caps|multi_heap|malloc|free\b|operator new|operator delete|tlsf_"),
+    ("idle", r"prvIdleTask|esp_vApplicationIdleHook|vApplicationIdleHook|esp_pm_impl_waiti|cpu_ll_waiti"),
+    ("freertos", r"xQueue|xTask|vTask|vPort|xPort|_xt_|prvCopyData|uxList"),
+    ("app", r"SyncManager|FireDetector|FirebaseManager|RelayAggregator|PresenceManager|"
+            r"BackfillScheduler|HistoryEncoder|RemoteConfig|MemoryMonitor|FailureDetector|"
+            r"receivedCallback|handleReading|generateSensorData|processUploads"),
+]
+
+TEXT_TYPES = set("tTwW")
+NM_LINE = re.compile(r"^([0-9a-fA-F]+)\s+(?:([0-9a-fA-F]+)\s+)?([A-Za-z])\s+(.+)$")
+
+
+def parse_dump(lines):
+    """Último volcado PROF de la captura: cabecera, tareas y PCs."""
+    dump = None
+    for raw in lines:
+        line = raw.strip()
+        idx = line.find("PROF ")
+        if idx < 0:
+            continue
+        parts = line[idx:].split()
+
+        if parts[1] == "BEGIN":
+            header = dict(p.split("=", 1) for p in parts[2:] if "=" in p)
+            dump = {"header": {k: int(v) for k, v in header.items()}, "tasks": {}, "pcs": {}}
+        elif dump is None:
+            continue
+        elif parts[1] == "T" and len(parts) >= 4:
+            name = " ".join(parts[2:-1])
+            dump["tasks"][name] = dump["tasks"].get(name, 0) + int(parts[-1])
+        elif parts[1] == "P" and len(parts) == 4:
+            pc = int(parts[2], 16)
+            dump["pcs"][pc] = dump["pcs"].get(pc, 0) + int(parts[3])
+        elif parts[1] == "END":
+            dump["complete"] = True
+
+    if dump is None:
+        raise ValueError("no se encontró ningún volcado 'PROF BEGIN' en la captura")
+    return dump
+
+
+def parse_symbols(lines):
+    """Tabla ordenada (dirección, tamaño, nombre) a partir de la salida de nm."""
+    symbols = []
+    for raw in lines:
+        match = NM_LINE.match(raw.rstrip("\n"))
+        if not match or match.group(3) not in TEXT_TYPES:
+            continue
+        size = int(match.group(2), 16) if match.group(2) else 0
+        symbols.append((int(match.group(1), 16), size, match.group(4)))
+    symbols.sort()
+    return symbols
+
+
+def find_tool(name, explicit):
+    if explicit:
+        return explicit
+    candidates = [
+        os.path.expanduser("~/.platformio/packages/toolchain-xtensa-esp32/bin/" + name),
+        shutil.which(name),
+    ]
+    for path in candidates:
+        if path and os.path.exists(path):
+            return path
+    raise FileNotFoundError("no se encontró %s (usar --nm/--addr2line o --symbols)" % name)
+
+
+def load_symbols(args):
+    if args.symbols:
+        with open(args.symbols, encoding="utf-8", errors="replace") as fh:
+            return parse_symbols(fh)
+    nm = find_tool("xtensa-esp32-elf-nm", args.nm)
+    out = subprocess.run([nm, "-n", "-C", "-S", "--defined-only", args.elf],
+                         check=True, capture_output=True, text=True).stdout
+    return parse_symbols(out.splitlines())
+
+
+def symbolize(pc, symbols, starts):
+    i = bisect.bisect_right(starts, pc) - 1
+    if i < 0:
+        return "?"
+    addr, size, name = symbols[i]
+    if size and pc >= addr + size:
+        return "?"
+    return name
+
+
+def source_lines(pcs, args):
+    """archivo:línea por PC con addr2line (opcional, requiere el ELF)."""
+    if not args.lines or not args.elf:
+        return {}
+    tool = find_tool("xtensa-esp32-elf-addr2line", args.addr2line)
+    ordered = sorted(pcs)
+    out = subprocess.run([tool, "-e", args.elf] + ["0x%08x" % pc for pc in ordered],
+                         check=True, capture_output=True, text=True).stdout.splitlines()
+    return {pc: os.path.basename(loc) for pc, loc in zip(ordered, out)}
+
+
+def categorize(name):
+    for category, pattern in CATEGORIES:
+        if re.search(pattern, name):
+            return category
+    return "otros"
+
+
+def build_report(dump, symbols, locations=None):
+    starts = [s[0] for s in symbols]
+    locations = locations or {}
+
+    functions = {}
+    categories = {}
+    for pc, count in dump["pcs"].items():
+        name = symbolize(pc, symbols, starts)
+        entry = functions.setdefault(name, {"samples": 0, "where": locations.get(pc, "")})
+        entry["samples"] += count
+        cat = categorize(name)
+        categories[cat] = categories.get(cat, 0) + count
+
+    return {
+        "header": dump["header"],
+        "complete": dump.get("complete", False),
+        "tasks": dict(sorted(dump["tasks"].items(), key=lambda kv: -kv[1])),
+        "categories": dict(sorted(categories.items(), key=lambda kv: -kv[1])),
+        "functions": sorted(({"name": k, **v} for k, v in functions.items()),
+                            key=lambda f: -f["samples"]),
+    }
+
+
+def format_report(report, top):
+    header = report["header"]
+    total = header.get("samples", 0) or sum(f["samples"] for f in report["functions"]) or 1
+    hz = header.get("hz", 0)
+
+    out = []
+    out.append("Profile: %d muestras @ %d Hz (%.1f s) | descartadas %d | otras tareas %d | en ISR %d%s" % (
+        total, hz, header.get("ms", 0) / 1000.0, header.get("dropped", 0),
+        header.get("other", 0), header.get("nested", 0),
+        "" if report["complete"] else " | VOLCADO INCOMPLETO"))
+
+    def pct(n):
+        return 100.0 * n / total
+
+    out.append("")
+    out.append("Por tarea:")
+    for name, count in report["tasks"].items():
+        out.append("  %-20s %8d  %5.1f%%" % (name, count, pct(count)))
+
+    out.append("")
+    out.append("Por subsistema:")
+    for name, count in report["categories"].items():
+        out.append("  %-20s %8d  %5.1f%%" % (name, count, pct(count)))
+
+    out.append("")
+    out.append("Top %d funciones:" % top)
+    for fn in report["functions"][:top]:
+        where = ("  [%s]" % fn["where"]) if fn["where"] else ""
+        out.append("  %8d  %5.1f%%  %s%s" % (fn["samples"], pct(fn["samples"]), fn["name"], where))
+    return "\n".join(out)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Simboliza un volcado 'prof' del firmware")
+    parser.add_argument("capture", help="captura de Serial con el volcado (o '-' para stdin)")
+    parser.add_argument("--elf", help="firmware.elf del entorno *_diag")
+    parser.add_argument("--symbols", help="salida de nm ya generada (no requiere toolchain)")
+    parser.add_argument("--nm", help="ruta a xtensa-esp32-elf-nm")
+    parser.add_argument("--addr2line", help="ruta a xtensa-esp32-elf-addr2line")
+    parser.add_argument("--lines", action="store_true", help="añadir archivo:línea (addr2line)")
+    parser.add_argument("--top", type=int, default=25)
+    parser.add_argument("--json", action="store_true", help="salida JSON para comparar perfiles")
+    args = parser.parse_args(argv)
+
+    if not args.elf and not args.symbols:
+        parser.error("se necesita --elf o --symbols")
+
+    if args.capture == "-":
+        dump = parse_dump(sys.stdin)
+    else:
+        with open(args.capture, encoding="utf-8", errors="replace") as fh:
+            dump = parse_dump(fh)
+
+    symbols = load_symbols(args)
+    report = build_report(dump, symbols, source_lines(dump["pcs"], args))
+
+    if args.json:
+        print(json.dumps(report, indent=2))
+    else:
+        print(format_report(report, args.top))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
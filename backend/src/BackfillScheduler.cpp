@@ -0,0 +1,91 @@
+#include "BackfillScheduler.hpp"
+#include "Log.hpp"
+
+BackfillScheduler::BackfillScheduler(int maxConcurrent, int blocksPerGrant, unsigned long grantTimeoutMs)
+    : maxConcurrent(maxConcurrent), blocksPerGrant(blocksPerGrant),
+      grantTimeoutMs(grantTimeoutMs), grantsIssued(0),
+      recoveriesCompleted(0), lastRecoveryMs(0) {}
+
+void BackfillScheduler::onAdvertise(uint32_t nodeId, uint32_t pending, bool windowEnd, unsigned long now) {
+    auto it = requests.find(nodeId);
+
+    if (pending == 0) {
+        if (it == requests.end()) return;
+
+        lastRecoveryMs = now - it->second.firstRequestMs;
+        recoveriesCompleted++;
+        LOG_I("[BACKFILL] Nodo %u recuperado en %lu ms", nodeId, lastRecoveryMs);
+        requests.erase(it);
+        return;
+    }
+
+    if (it == requests.end()) {
+        BackfillRequest req = {pending, now, 0, false};
+        requests[nodeId] = req;
+        LOG_I("[BACKFILL] Nodo %u anuncia %u lecturas en buffer", nodeId, pending);
+        return;
+    }
+
+    it->second.pending = pending;
+    if (windowEnd) it->second.active = false;
+}
+
+// Siguiente nodo a conceder; el llamador decide si la carga lo permite
+bool BackfillScheduler::nextGrant(uint32_t& nodeId, unsigned long now) {
+    int active = 0;
+    BackfillRequest* best = nullptr;
+    uint32_t bestId = 0;
+
+    for (auto& kv : requests) {
+        BackfillRequest& req = kv.second;
+
+        // Ventana sin cierre (child caído o BUF perdido): liberar el turno
+        if (req.active && now - req.grantedMs > grantTimeoutMs) {
+            LOG_W("[BACKFILL] Ventana de nodo %u expirada", kv.first);
+            req.active = false;
+        }
+
+        if (req.active) {
+            active++;
+        } else if (!best || req.grantedMs < best->grantedMs) {
+            best = &req;
+            bestId = kv.first;
+        }
+    }
+
+    if (!best || active >= maxConcurrent) return false;
+
+    best->active = true;
+    best->grantedMs = now;
+    grantsIssued++;
+    nodeId = bestId;
+    return true;
+}
+
+void BackfillScheduler::forget(uint32_t nodeId) {
+    requests.erase(nodeId);
+}
+
+bool BackfillScheduler::isRecovering() {
+    return !requests.empty();
+}
+
+size_t BackfillScheduler::waitingCount() {
+    return requests.size();
+}
+
+int BackfillScheduler::getBlocksPerGrant() {
+    return blocksPerGrant;
+}
+
+uint32_t BackfillScheduler::getGrantsIssued() {
+    return grantsIssued;
+}
+
+uint32_t BackfillScheduler::getRecoveriesCompleted() {
+    return recoveriesCompleted;
+}
+
+unsigned long BackfillScheduler::getLastRecoveryMs() {
+    return lastRecoveryMs;
+}
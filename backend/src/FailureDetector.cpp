@@ -0,0 +1,61 @@
+#include "FailureDetector.hpp"
+#include <math.h>
+
+// Muestras mínimas antes de confiar en la distribución
+static const int FD_MIN_SAMPLES = 4;
+
+FailureDetector::FailureDetector(double phiThreshold, unsigned long maxSilenceMs,
+                                 unsigned long minStdDevMs)
+    : count(0), next(0), lastHeartbeat(0), phiThreshold(phiThreshold),
+      minStdDevMs(minStdDevMs), maxSilenceMs(maxSilenceMs) {}
+
+void FailureDetector::reset() {
+    count = 0;
+    next = 0;
+    lastHeartbeat = 0;
+}
+
+void FailureDetector::heartbeat(unsigned long now) {
+    if (lastHeartbeat != 0) {
+        intervals[next] = now - lastHeartbeat;
+        next = (next + 1) % FD_WINDOW;
+        if (count < FD_WINDOW) count++;
+    }
+    lastHeartbeat = now;
+}
+
+double FailureDetector::phi(unsigned long now) {
+    if (count < FD_MIN_SAMPLES || lastHeartbeat == 0) return 0.0;
+
+    double mean = 0.0;
+    for (int i = 0; i < count; i++) mean += intervals[i];
+    mean /= count;
+
+    double variance = 0.0;
+    for (int i = 0; i < count; i++) {
+        double d = intervals[i] - mean;
+        variance += d * d;
+    }
+    double stdDev = sqrt(variance / count);
+    if (stdDev < minStdDevMs) stdDev = minStdDevMs;
+
+    // phi = -log10(P(intervalo > t)) con intervalos ~ N(mean, stdDev)
+    double t = (double)(now - lastHeartbeat);
+    double pLater = 0.5 * erfc((t - mean) / (stdDev * M_SQRT2));
+    if (pLater <= 0.0) return INFINITY;
+    return -log10(pLater);
+}
+
+// Cota dura: nunca se tarda más de maxSilenceMs en sospechar
+bool FailureDetector::isSuspected(unsigned long now) {
+    if (lastHeartbeat == 0) return false;
+    return silence(now) >= maxSilenceMs || phi(now) >= phiThreshold;
+}
+
+unsigned long FailureDetector::silence(unsigned long now) {
+    return lastHeartbeat == 0 ? 0 : now - lastHeartbeat;
+}
+
+bool FailureDetector::hasHeartbeat() {
+    return lastHeartbeat != 0;
+}
@@ -0,0 +1,102 @@
+#include "FireDetector.hpp"
+
+FireDetector::FireDetector(FireDetectorConfig cfg)
+    : config(cfg), eventCallback(nullptr) {}
+
+void FireDetector::onEvent(void (*callback)(const FireEvent&)) {
+    eventCallback = callback;
+}
+
+void FireDetector::update(uint32_t nodeId, unsigned long long ts, int humo, int fuego, bool networkTime) {
+    DetectorState& st = states[nodeId];
+
+    // Una serie nunca mezcla bases de tiempo: al sincronizarse el nodo empieza de nuevo
+    if (!st.initialized || st.networkTime != networkTime) {
+        st.initialized = true;
+        st.networkTime = networkTime;
+        st.lastTs = ts;
+        st.mean = humo;
+        st.baseline = humo;
+        st.slope = 0.0;
+        st.cusum = 0.0;
+        st.activeEvents = 0;
+        return;
+    }
+
+    // Lecturas fuera de orden o repetidas no aportan pendiente
+    double dt = (ts > st.lastTs) ? (double)(ts - st.lastTs) / 1000.0 : 0.0;
+    st.lastTs = ts > st.lastTs ? ts : st.lastTs;
+
+    double prevMean = st.mean;
+    st.mean += config.meanAlpha * ((double)humo - st.mean);
+
+    if (dt > 0.0) {
+        double instSlope = (st.mean - prevMean) / dt;
+        st.slope += config.slopeAlpha * (instSlope - st.slope);
+    }
+
+    // CUSUM unilateral (solo subidas) contra una línea base lenta
+    st.cusum += (double)humo - st.baseline - config.cusumDrift;
+    if (st.cusum < 0.0) st.cusum = 0.0;
+
+    bool changePoint = st.cusum > config.cusumThreshold;
+    if (!changePoint) {
+        // La línea base solo aprende mientras no hay cambio en curso
+        st.baseline += config.baselineAlpha * ((double)humo - st.baseline);
+    }
+
+    bool rising = st.slope > config.slopeThreshold;
+    bool smokeEvidence = rising || changePoint || humo >= config.smokeEvidence;
+
+    raise(st, EVENT_RATE_OF_RISE, rising, nodeId, ts, humo);
+    raise(st, EVENT_CHANGE_POINT, changePoint, nodeId, ts, humo);
+    raise(st, EVENT_FLAME_CONFIRMED, fuego && smokeEvidence, nodeId, ts, humo);
+    raise(st, EVENT_FLAME_UNCONFIRMED, fuego && !smokeEvidence, nodeId, ts, humo);
+}
+
+// Emite solo en el flanco de subida; el evento se rearma cuando la condición cesa
+void FireDetector::raise(DetectorState& st, FireEventType type, bool active, uint32_t nodeId,
+                         unsigned long long ts, int humo) {
+    if (!active) {
+        st.activeEvents &= ~type;
+        return;
+    }
+    if (st.activeEvents & type) return;
+
+    st.activeEvents |= type;
+    if (eventCallback == nullptr) return;
+
+    FireEvent evt;
+    evt.nodeId = nodeId;
+    evt.type = type;
+    evt.ts = ts;
+    evt.humo = humo;
+    evt.slope = st.slope;
+    evt.cusum = st.cusum;
+    eventCallback(evt);
+}
+
+void FireDetector::forget(uint32_t nodeId) {
+    states.erase(nodeId);
+}
+
+// Subida de humo en curso (rate-of-rise o CUSUM), aunque no llegue al umbral crítico
+bool FireDetector::isAlerting(uint32_t nodeId) {
+    auto it = states.find(nodeId);
+    if (it == states.end()) return false;
+    return (it->second.activeEvents & (EVENT_RATE_OF_RISE | EVENT_CHANGE_POINT)) != 0;
+}
+
+size_t FireDetector::trackedNodes() {
+    return states.size();
+}
+
+const char* FireDetector::eventName(FireEventType type) {
+    switch (type) {
+        case EVENT_RATE_OF_RISE:      return "RATE_OF_RISE";
+        case EVENT_CHANGE_POINT:      return "CHANGE_POINT";
+        case EVENT_FLAME_CONFIRMED:   return "FLAME_CONFIRMED";
+        case EVENT_FLAME_UNCONFIRMED: return "FLAME_UNCONFIRMED";
+    }
+    return "UNKNOWN";
+}
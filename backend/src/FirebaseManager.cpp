@@ -1,9 +1,12 @@
 #include "FirebaseManager.hpp"
+#include "Log.hpp"
 #include <Firebase_ESP_Client.h>
 #include "addons/TokenHelper.h"
 #include "addons/RTDBHelper.h"
 
-FirebaseManager::FirebaseManager() : ready(false) {}
+FirebaseManager::FirebaseManager(size_t maxQueue, size_t maxAlerts)
+    : streaming(false), ready(false), snapshotKeyNext(0), maxQueueSize(maxQueue),
+      maxAlerts(maxAlerts), droppedUploads(0) {}
 
 FirebaseManager::~FirebaseManager() {}
 
@@ -45,7 +48,7 @@ bool FirebaseManager::isReady() {
     return ready && Firebase.ready();
 }
 
-bool FirebaseManager::sendData(int humo, int fuego, unsigned long long ts, String tipo, uint32_t nodeId) {
+bool FirebaseManager::sendData(int humo, int fuego, unsigned long long ts, const char* tipo, uint32_t nodeId) {
     if (!isReady()) return false;
 
     FirebaseJson json;
@@ -56,14 +59,41 @@ bool FirebaseManager::sendData(int humo, int fuego, unsigned long long ts, Strin
     json.set("nodeId", (int)nodeId);
     json.set("serverTimestamp", (double)millis());
 
-    String path = "sensores/node_";
+    String path;
+    path.reserve(40);
+    path += "sensores/node_";
     path += nodeId;
     path += "/lecturas";
 
     if (Firebase.RTDB.pushJSON(&fbdo, path.c_str(), &json)) {
         return true;
     } else {
-        Serial.printf("[Firebase] Error: %s\n", fbdo.errorReason().c_str());
+        LOG_E("[Firebase] Error: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+}
+
+bool FirebaseManager::sendAlert(const PendingAlert& alert) {
+    if (!isReady()) return false;
+
+    FirebaseJson json;
+    json.set("event", alert.evento);
+    json.set("humo", alert.humo);
+    json.set("slope", alert.slope);
+    json.set("cusum", alert.cusum);
+    json.set("timestamp", (double)alert.ts);
+    json.set("nodeId", (int)alert.nodeId);
+    json.set("serverTimestamp", (double)millis());
+
+    String path;
+    path.reserve(40);
+    path += "alertas/node_";
+    path += alert.nodeId;
+
+    if (Firebase.RTDB.pushJSON(&fbdo, path.c_str(), &json)) {
+        return true;
+    } else {
+        LOG_E("[Firebase] Error alerta: %s", fbdo.errorReason().c_str());
         return false;
     }
 }
@@ -71,3 +101,322 @@ bool FirebaseManager::sendData(int humo, int fuego, unsigned long long ts, Strin
 void FirebaseManager::reconnect() {
     Firebase.reconnectWiFi(true);
 }
+
+// Un registro por bloque: el dashboard lo expande a lecturas individuales
+bool FirebaseManager::sendBlock(const PendingBlock& block) {
+    if (!isReady()) return false;
+
+    FirebaseJson json;
+    json.set("type", "DATA_BLK");
+    json.set("t0", (double)block.t0);
+    json.set("t1", (double)block.t1);
+    json.set("n", block.count);
+    json.set("blk", block.blk);
+    json.set("nodeId", (int)block.nodeId);
+    json.set("serverTimestamp", (double)millis());
+
+    String path;
+    path.reserve(40);
+    path += "sensores/node_";
+    path += block.nodeId;
+    path += "/lecturas";
+
+    if (Firebase.RTDB.pushJSON(&fbdo, path.c_str(), &json)) {
+        return true;
+    } else {
+        LOG_E("[Firebase] Error bloque: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+}
+
+bool FirebaseManager::sendStatus(uint32_t nodeId, const String& statusJson) {
+    if (!isReady()) return false;
+
+    FirebaseJson json;
+    json.setJsonData(statusJson);
+    json.set("nodeId", (int)nodeId);
+    json.set("serverTimestamp", (double)millis());
+
+    String path;
+    path.reserve(40);
+    path += "estado/node_";
+    path += nodeId;
+
+    if (Firebase.RTDB.setJSON(&fbdo, path.c_str(), &json)) {
+        return true;
+    } else {
+        LOG_E("[Firebase] Error estado: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+}
+
+// ========== CONFIGURACIÓN REMOTA ==========
+bool FirebaseManager::beginConfigStream(const char* path) {
+    if (!isReady()) return false;
+
+    configPath = path;
+    streaming = Firebase.RTDB.beginStream(&stream, path);
+    if (!streaming) {
+        LOG_E("[Firebase] Error stream config: %s", stream.errorReason().c_str());
+    }
+    return streaming;
+}
+
+// Sondeo no bloqueante; devuelve el documento completo cuando cambia
+bool FirebaseManager::pollConfig(String& json) {
+    if (!streaming || !isReady()) return false;
+
+    if (!Firebase.RTDB.readStream(&stream)) {
+        LOG_W("[Firebase] Stream config: %s", stream.errorReason().c_str());
+        return false;
+    }
+    if (!stream.streamAvailable()) return false;
+
+    // Un cambio parcial solo trae la subruta: releer el documento entero
+    if (stream.dataPath() == "/" && stream.dataType() == "json") {
+        json = stream.jsonString();
+        return true;
+    }
+    if (Firebase.RTDB.getJSON(&fbdo, configPath.c_str())) {
+        json = fbdo.jsonString();
+        return true;
+    }
+    LOG_E("[Firebase] Error leyendo config: %s", fbdo.errorReason().c_str());
+    return false;
+}
+
+// Parche parcial sobre "presencia": solo viajan los nodos que cambiaron
+bool FirebaseManager::updatePresence(FirebaseJson& delta) {
+    if (!isReady()) return false;
+
+    if (Firebase.RTDB.updateNode(&fbdo, "presencia", &delta)) {
+        return true;
+    } else {
+        LOG_E("[Firebase] Error presencia: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+}
+
+void FirebaseManager::rememberSnapshotKey(unsigned long long ts) {
+    snapshotKeys[snapshotKeyNext].ts = ts;
+    snapshotKeys[snapshotKeyNext].key = fbdo.pushName();
+    snapshotKeyNext = (snapshotKeyNext + 1) % SNAPSHOT_KEY_MEMORY;
+}
+
+// Un registro por tick en snapshots/{pushKey} con ts como campo y la hora del
+// servidor en "at"; las lecturas tardías se fusionan en snapshots/{pushKey}/nodes
+bool FirebaseManager::sendSnapshot(const PendingSnapshot& snapshot) {
+    if (!isReady()) return false;
+
+    FirebaseJson json;
+    json.setJsonData(snapshot.json);
+
+    if (snapshot.late) {
+        const SnapshotKey* known = nullptr;
+        for (int i = 0; i < SNAPSHOT_KEY_MEMORY; i++) {
+            if (snapshotKeys[i].ts == snapshot.ts && snapshotKeys[i].key.length() > 0) {
+                known = &snapshotKeys[i];
+            }
+        }
+        // Registro original descartado o fallido: las lecturas con hora de red
+        // solo existen en snapshots, así que van en un registro propio
+        if (!known) {
+            FirebaseJson orphan;
+            orphan.setJsonData("{\"nodes\":" + snapshot.json + "}");
+            orphan.set("ts", (double)snapshot.ts);
+            orphan.set("late", true);
+            orphan.set("at/.sv", "timestamp");
+            if (Firebase.RTDB.pushJSON(&fbdo, "snapshots", &orphan)) {
+                rememberSnapshotKey(snapshot.ts);
+                return true;
+            }
+            LOG_E("[Firebase] Error snapshot: %s", fbdo.errorReason().c_str());
+            return false;
+        }
+
+        String path = "snapshots/" + known->key + "/nodes";
+        if (Firebase.RTDB.updateNode(&fbdo, path, &json)) {
+            return true;
+        }
+        LOG_E("[Firebase] Error snapshot: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+
+    json.set("at/.sv", "timestamp");
+    if (Firebase.RTDB.pushJSON(&fbdo, "snapshots", &json)) {
+        rememberSnapshotKey(snapshot.ts);
+        return true;
+    } else {
+        LOG_E("[Firebase] Error snapshot: %s", fbdo.errorReason().c_str());
+        return false;
+    }
+}
+
+void FirebaseManager::enqueueStatus(uint32_t nodeId, const String& statusJson) {
+    pendingStatus[nodeId] = statusJson;
+}
+
+// Cola llena y llega una lectura crítica: sale la lectura normal más antigua
+// y, si no hay, el bloque de historial más antiguo
+bool FirebaseManager::evictForCritical() {
+    for (auto it = uploadQueue.begin(); it != uploadQueue.end(); ++it) {
+        if (it->critical) continue;
+        LOG_W("[Firebase] Cola llena. Lectura de nodo %u descartada por una crítica.", it->nodeId);
+        uploadQueue.erase(it);
+        droppedUploads++;
+        return true;
+    }
+    for (auto it = snapshotQueue.begin(); it != snapshotQueue.end(); ++it) {
+        if (it->critical) continue;
+        LOG_W("[Firebase] Cola llena. Snapshot %llu descartado por una lectura crítica.", it->ts);
+        snapshotQueue.erase(it);
+        droppedUploads++;
+        return true;
+    }
+    if (!blockQueue.empty()) {
+        LOG_W("[Firebase] Cola llena. Bloque de %d lecturas descartado por una crítica.",
+              blockQueue.front().count);
+        droppedUploads += blockQueue.front().count;
+        blockQueue.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool FirebaseManager::enqueueData(int humo, int fuego, unsigned long long ts, const char* tipo,
+                                  uint32_t nodeId, bool critical) {
+    if (getBacklog() >= maxQueueSize && !(critical && evictForCritical())) {
+        droppedUploads++;
+        LOG_W("[Firebase] Cola llena (%u). Lectura de nodo %u descartada.",
+              (unsigned)uploadQueue.size(), nodeId);
+        return false;
+    }
+
+    PendingUpload item;
+    item.ts = ts;
+    item.nodeId = nodeId;
+    item.humo = humo;
+    item.fuego = fuego;
+    strncpy(item.tipo, tipo, sizeof(item.tipo) - 1);
+    item.tipo[sizeof(item.tipo) - 1] = '\0';
+    item.critical = critical;
+    uploadQueue.push_back(item);
+    return true;
+}
+
+bool FirebaseManager::enqueueBlock(uint32_t nodeId, unsigned long long t0, unsigned long long t1,
+                                   int count, const char* blk) {
+    if (getBacklog() >= maxQueueSize) {
+        droppedUploads += count;
+        LOG_W("[Firebase] Cola llena. Bloque de %d lecturas de nodo %u descartado.",
+              count, nodeId);
+        return false;
+    }
+
+    PendingBlock block;
+    block.t0 = t0;
+    block.t1 = t1;
+    block.nodeId = nodeId;
+    block.count = count;
+    block.blk = blk;
+    blockQueue.push_back(block);
+    return true;
+}
+
+bool FirebaseManager::enqueueSnapshot(unsigned long long ts, bool late, const String& json,
+                                      bool critical) {
+    if (getBacklog() >= maxQueueSize && !(critical && evictForCritical())) {
+        droppedUploads++;
+        LOG_W("[Firebase] Cola llena. Snapshot %llu descartado.", ts);
+        return false;
+    }
+
+    PendingSnapshot snapshot;
+    snapshot.ts = ts;
+    snapshot.late = late;
+    snapshot.critical = critical;
+    snapshot.json = json;
+    snapshotQueue.push_back(snapshot);
+    return true;
+}
+
+int FirebaseManager::processQueue(int maxItems) {
+    int sent = 0;
+
+    // Alertas: pocas y críticas, por delante de todo
+    while (sent < maxItems && !alertQueue.empty() && isReady()) {
+        if (!sendAlert(alertQueue.front())) break;
+        alertQueue.pop_front();
+        sent++;
+    }
+
+    // Snapshots de flota: son los datos en vivo, van primero
+    while (sent < maxItems && alertQueue.empty() && !snapshotQueue.empty() && isReady()) {
+        if (!sendSnapshot(snapshotQueue.front())) break;
+        snapshotQueue.pop_front();
+        sent++;
+    }
+
+    while (sent < maxItems && snapshotQueue.empty() && !uploadQueue.empty() && isReady()) {
+        const PendingUpload& item = uploadQueue.front();
+        if (!sendData(item.humo, item.fuego, item.ts, item.tipo, item.nodeId)) {
+            break;  // Reintentar en la siguiente pasada
+        }
+        uploadQueue.pop_front();
+        sent++;
+    }
+
+    // El historial va detrás de las lecturas en vivo
+    while (sent < maxItems && snapshotQueue.empty() && uploadQueue.empty() &&
+           !blockQueue.empty() && isReady()) {
+        if (!sendBlock(blockQueue.front())) break;
+        blockQueue.pop_front();
+        sent++;
+    }
+
+    // Los estados periódicos solo ocupan huecos sin lecturas pendientes
+    while (sent < maxItems && snapshotQueue.empty() && uploadQueue.empty() &&
+           blockQueue.empty() && !pendingStatus.empty() && isReady()) {
+        auto it = pendingStatus.begin();
+        if (!sendStatus(it->first, it->second)) break;
+        pendingStatus.erase(it);
+        sent++;
+    }
+    return sent;
+}
+
+size_t FirebaseManager::getBacklog() {
+    return snapshotQueue.size() + uploadQueue.size() + blockQueue.size();
+}
+
+// 0 = libre, 1 = cargado, 2 = congestionado, 3 = saturado
+uint8_t FirebaseManager::getCongestionLevel() {
+    size_t backlog = getBacklog();
+    if (backlog * 4 >= maxQueueSize * 3) return 3;
+    if (backlog * 2 >= maxQueueSize) return 2;
+    if (backlog * 4 >= maxQueueSize) return 1;
+    return 0;
+}
+
+uint32_t FirebaseManager::getDroppedUploads() {
+    return droppedUploads;
+}
+
+// Cola propia y acotada: una ráfaga de lecturas no debe tirar una alerta
+bool FirebaseManager::enqueueAlert(const char* evento, int humo, double slope, double cusum,
+                                   unsigned long long ts, uint32_t nodeId) {
+    if (alertQueue.size() >= maxAlerts) {
+        LOG_W("[Firebase] Cola de alertas llena. %s de nodo %u descartada.", evento, nodeId);
+        return false;
+    }
+
+    PendingAlert alert;
+    alert.ts = ts;
+    alert.nodeId = nodeId;
+    alert.humo = humo;
+    alert.slope = slope;
+    alert.cusum = cusum;
+    alert.evento = evento;
+    alertQueue.push_back(alert);
+    return true;
+}
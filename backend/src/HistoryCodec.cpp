@@ -0,0 +1,139 @@
+#include "HistoryCodec.hpp"
+
+static const char BASE64_CHARS[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Zigzag: enteros con signo pequeños -> sin signo pequeños
+static inline uint64_t zigzag(long long v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+HistoryEncoder::HistoryEncoder(size_t maxSamples) : maxSamples(maxSamples) {
+    bytes.reserve(maxSamples * 2 + 4);
+    reset();
+}
+
+void HistoryEncoder::reset() {
+    bytes.clear();
+    bitPos = 0;
+    samples = 0;
+    firstTs = 0;
+    lastTs = 0;
+    lastDelta = 0;
+    lastHumo = 0;
+}
+
+// Escribe los 'bits' menos significativos de value, MSB primero
+void HistoryEncoder::writeBits(uint32_t value, uint8_t bits) {
+    while (bits > 0) {
+        if (bitPos == 0) bytes.push_back(0);
+
+        uint8_t room = 8 - bitPos;
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (value >> (bits - take)) & ((1u << take) - 1);
+
+        bytes.back() |= chunk << (room - take);
+        bitPos = (bitPos + take) & 7;
+        bits -= take;
+    }
+}
+
+// '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32 (valores zigzag)
+void HistoryEncoder::writeTimestamp(long long dod) {
+    uint64_t zz = zigzag(dod);
+    if (zz == 0) {
+        writeBits(0, 1);
+    } else if (zz < (1u << 7)) {
+        writeBits(0x2, 2);
+        writeBits(zz, 7);
+    } else if (zz < (1u << 9)) {
+        writeBits(0x6, 3);
+        writeBits(zz, 9);
+    } else if (zz < (1u << 12)) {
+        writeBits(0xE, 4);
+        writeBits(zz, 12);
+    } else {
+        writeBits(0xF, 4);
+        writeBits((uint32_t)zz, 32);
+    }
+}
+
+// '0' | '10'+6 | '110'+9 | '111'+16 (valores zigzag)
+void HistoryEncoder::writeValue(int delta) {
+    uint64_t zz = zigzag(delta);
+    if (zz == 0) {
+        writeBits(0, 1);
+    } else if (zz < (1u << 6)) {
+        writeBits(0x2, 2);
+        writeBits(zz, 6);
+    } else if (zz < (1u << 9)) {
+        writeBits(0x6, 3);
+        writeBits(zz, 9);
+    } else {
+        writeBits(0x7, 3);
+        writeBits(zz, 16);
+    }
+}
+
+// Devuelve false si la muestra no cabe en este bloque
+bool HistoryEncoder::add(const DataPacket& data) {
+    if (samples >= maxSamples) return false;
+
+    if (samples == 0) {
+        firstTs = data.timestamp;
+        writeBits((uint32_t)data.humo & 0xFFFF, 16);
+    } else {
+        long long delta = (long long)(data.timestamp - lastTs);
+        long long dod = delta - lastDelta;
+
+        // El campo largo del delta-of-delta es de 32 bits (~24 días)
+        if (dod > INT32_MAX / 2 || dod < -(INT32_MAX / 2)) return false;
+
+        writeTimestamp(dod);
+        writeValue(data.humo - lastHumo);
+        lastDelta = delta;
+    }
+
+    writeBits(data.fuego ? 1 : 0, 1);
+    lastTs = data.timestamp;
+    lastHumo = data.humo;
+    samples++;
+    return true;
+}
+
+bool HistoryEncoder::isFull() {
+    return samples >= maxSamples;
+}
+
+size_t HistoryEncoder::count() {
+    return samples;
+}
+
+unsigned long long HistoryEncoder::getFirstTs() {
+    return firstTs;
+}
+
+unsigned long long HistoryEncoder::getLastTs() {
+    return lastTs;
+}
+
+size_t HistoryEncoder::encodedSize() {
+    return bytes.size();
+}
+
+String HistoryEncoder::toBase64() {
+    String out;
+    out.reserve(((bytes.size() + 2) / 3) * 4 + 1);
+
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t chunk = (uint32_t)bytes[i] << 16;
+        if (i + 1 < bytes.size()) chunk |= (uint32_t)bytes[i + 1] << 8;
+        if (i + 2 < bytes.size()) chunk |= bytes[i + 2];
+
+        out += BASE64_CHARS[(chunk >> 18) & 0x3F];
+        out += BASE64_CHARS[(chunk >> 12) & 0x3F];
+        out += (i + 1 < bytes.size()) ? BASE64_CHARS[(chunk >> 6) & 0x3F] : '=';
+        out += (i + 2 < bytes.size()) ? BASE64_CHARS[chunk & 0x3F] : '=';
+    }
+    return out;
+}
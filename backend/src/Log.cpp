@@ -0,0 +1,191 @@
+#include "Log.hpp"
+#include <atomic>
+
+namespace Log {
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE debe ser potencia de 2");
+
+// Ring SPSC: productor = tarea del loop (callbacks mesh incluidos), consumidor = drain()
+static LogRecord ring[LOG_RING_SIZE];
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> tail(0);
+static uint32_t dropped = 0;
+
+static const char LEVEL_TAGS[] = "-EWID";
+
+bool reserve(LogRecord*& rec, uint8_t level, const char* fmt) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= LOG_RING_SIZE) {
+        dropped++;
+        return false;
+    }
+
+    rec = &ring[h & (LOG_RING_SIZE - 1)];
+    rec->ms = millis();
+    rec->fmt = fmt;
+    rec->level = level;
+    rec->argc = 0;
+    rec->str[0] = '\0';
+    return true;
+}
+
+void commit() {
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+uint32_t getDropped() {
+    return dropped;
+}
+
+// Formatea un registro procesando cada especificador por separado, de modo que
+// el tipo real del argumento se toma del formato y no de la pila de varargs.
+static size_t formatRecord(const LogRecord& rec, char* out, size_t cap) {
+    size_t len = snprintf(out, cap, "%c %lu ", LEVEL_TAGS[rec.level], (unsigned long)rec.ms);
+    uint8_t argIndex = 0;
+    const char* p = rec.fmt;
+
+    while (*p && len < cap - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // Extraer el especificador completo: %[flags][ancho][.prec][long]conv
+        char spec[16];
+        size_t specLen = 0;
+        int longs = 0;
+        const char* q = p;
+        spec[specLen++] = *q++;
+        while (*q && strchr("-+ #0123456789.", *q) && specLen < sizeof(spec) - 4) {
+            spec[specLen++] = *q++;
+        }
+        while (*q == 'l' || *q == 'h' || *q == 'z') {
+            if (*q == 'l') longs++;
+            q++;
+        }
+        char conv = *q ? *q++ : '\0';
+
+        // Reescribir el modificador de longitud según lo que se va a pasar
+        if (longs >= 2) { spec[specLen++] = 'l'; spec[specLen++] = 'l'; }
+        else if (longs == 1) { spec[specLen++] = 'l'; }
+        spec[specLen++] = conv;
+        spec[specLen] = '\0';
+
+        if (conv == '\0' || argIndex >= rec.argc) break;
+        uint64_t raw = rec.args[argIndex++];
+        char* dst = out + len;
+        size_t room = cap - len;
+        int n = 0;
+
+        switch (conv) {
+            case 's':
+                n = snprintf(dst, room, spec, rec.str);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                double d;
+                memcpy(&d, &raw, sizeof(d));
+                n = snprintf(dst, room, spec, d);
+                break;
+            }
+            case 'd': case 'i': case 'c':
+                if (longs >= 2) n = snprintf(dst, room, spec, (long long)raw);
+                else if (longs == 1) n = snprintf(dst, room, spec, (long)raw);
+                else n = snprintf(dst, room, spec, (int)raw);
+                break;
+            case 'p':
+                n = snprintf(dst, room, spec, (void*)(uintptr_t)raw);
+                break;
+            default:
+                if (longs >= 2) n = snprintf(dst, room, spec, (unsigned long long)raw);
+                else if (longs == 1) n = snprintf(dst, room, spec, (unsigned long)raw);
+                else n = snprintf(dst, room, spec, (unsigned)raw);
+                break;
+        }
+
+        if (n < 0) break;
+        len += ((size_t)n < room) ? (size_t)n : room - 1;
+        p = q;
+    }
+
+    out[len++] = '\n';
+    return len;
+}
+
+// Llamar desde loop(): solo escribe lo que cabe en la FIFO de la UART sin bloquear
+void drain(int maxRecords) {
+    static char line[160];
+    static size_t pendingLen = 0;
+    static size_t pendingOff = 0;
+    static uint32_t reportedDrops = 0;
+
+    while (maxRecords-- > 0) {
+        if (pendingOff == pendingLen) {
+            uint32_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire)) break;
+
+            pendingLen = formatRecord(ring[t & (LOG_RING_SIZE - 1)], line, sizeof(line) - 1);
+            pendingOff = 0;
+            tail.store(t + 1, std::memory_order_release);
+        }
+
+        // Escribir solo lo que la FIFO acepta; el resto sale en la próxima llamada
+        size_t room = Serial.availableForWrite();
+        size_t chunk = pendingLen - pendingOff;
+        if (chunk > room) chunk = room;
+        if (chunk == 0) return;
+
+        Serial.write((const uint8_t*)line + pendingOff, chunk);
+        pendingOff += chunk;
+        if (pendingOff < pendingLen) return;
+    }
+
+    if (dropped != reportedDrops && Serial.availableForWrite() >= 48) {
+        Serial.printf("W %lu [LOG] %lu registros descartados\n",
+                      (unsigned long)millis(), (unsigned long)(dropped - reportedDrops));
+        reportedDrops = dropped;
+    }
+}
+
+#endif
+
+#ifdef LOG_LOOP_STATS
+// Jitter del loop: hueco máximo y medio entre iteraciones, informado cada 10 s
+void measureLoop() {
+    static uint32_t last = 0;
+    static uint32_t windowStart = 0;
+    static uint32_t maxGap = 0;
+    static uint64_t sumGap = 0;
+    static uint32_t count = 0;
+
+    uint32_t now = micros();
+    if (last != 0) {
+        uint32_t gap = now - last;
+        if (gap > maxGap) maxGap = gap;
+        sumGap += gap;
+        count++;
+    } else {
+        windowStart = now;
+    }
+    last = now;
+
+    if (now - windowStart >= 10000000UL && count > 0) {
+        Serial.printf("[LOOP] max %lu us | media %lu us | n=%lu\n",
+                      (unsigned long)maxGap, (unsigned long)(sumGap / count),
+                      (unsigned long)count);
+        windowStart = now;
+        maxGap = 0;
+        sumGap = 0;
+        count = 0;
+        last = micros();  // No contar el propio printf como jitter
+    }
+}
+#endif
+
+}  // namespace Log
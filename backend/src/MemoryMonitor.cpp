@@ -0,0 +1,49 @@
+#include "MemoryMonitor.hpp"
+#include "Log.hpp"
+
+MemoryMonitor::MemoryMonitor() : taskCount(0) {}
+
+bool MemoryMonitor::registerTask(const char* name, TaskHandle_t handle) {
+    if (handle == nullptr || taskCount >= MEM_MAX_TASKS) return false;
+
+    tasks[taskCount] = handle;
+    taskNames[taskCount] = name;
+    taskCount++;
+    return true;
+}
+
+// Busca la tarea por nombre (p. ej. "async_tcp" creada por painlessMesh)
+bool MemoryMonitor::registerTask(const char* name) {
+    return registerTask(name, xTaskGetHandle(name));
+}
+
+MemorySnapshot MemoryMonitor::sample() {
+    MemorySnapshot snap;
+    snap.freeHeap = ESP.getFreeHeap();
+    snap.largestBlock = ESP.getMaxAllocHeap();
+    snap.minFreeHeap = ESP.getMinFreeHeap();
+    return snap;
+}
+
+void MemoryMonitor::fillJson(JsonObject obj) {
+    MemorySnapshot snap = sample();
+    obj["heap"] = snap.freeHeap;
+    obj["maxBlk"] = snap.largestBlock;
+    obj["minHeap"] = snap.minFreeHeap;
+
+    // High-water mark en bytes de pila nunca usados por cada tarea
+    JsonObject stacks = obj.createNestedObject("stk");
+    for (int i = 0; i < taskCount; i++) {
+        stacks[taskNames[i]] = uxTaskGetStackHighWaterMark(tasks[i]);
+    }
+}
+
+void MemoryMonitor::log() {
+    MemorySnapshot snap = sample();
+    LOG_I("[MEM] heap %u | bloque max %u | min histórico %u",
+          snap.freeHeap, snap.largestBlock, snap.minFreeHeap);
+    for (int i = 0; i < taskCount; i++) {
+        LOG_I("[MEM] pila libre %s: %u", taskNames[i],
+              (unsigned)uxTaskGetStackHighWaterMark(tasks[i]));
+    }
+}
@@ -0,0 +1,211 @@
+#include "PowerManager.hpp"
+#include "Log.hpp"
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <driver/gpio.h>
+
+// ========== ESTADO COMPARTIDO CON LA ISR ==========
+static portMUX_TYPE fireMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool fireEdge = false;
+static volatile uint32_t fireEdgeUs = 0;
+static TaskHandle_t loopTask = nullptr;
+
+// Flanco de subida en la entrada de fuego: despierta al loop si está en idle()
+static void IRAM_ATTR onFireEdge() {
+    portENTER_CRITICAL_ISR(&fireMux);
+    if (!fireEdge) {
+        fireEdgeUs = micros();
+        fireEdge = true;
+    }
+    portEXIT_CRITICAL_ISR(&fireMux);
+
+    BaseType_t woken = pdFALSE;
+    if (loopTask != nullptr) vTaskNotifyGiveFromISR(loopTask, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+PowerManager::PowerManager(bool enabled, unsigned long idleMaxMs, unsigned long lightSleepMinMs,
+                           unsigned long joinWindowMs, unsigned long joinRetryMs,
+                           unsigned long fireWakeGapMs)
+    : enabled(enabled), idleMaxMs(idleMaxMs), lightSleepMinMs(lightSleepMinMs),
+      joinWindowMs(joinWindowMs), joinRetryMs(joinRetryMs), fireWakeGapMs(fireWakeGapMs),
+      firePin(0), wasIsolated(false), joinWindowStartMs(0), hasFireWake(false), lastFireWakeMs(0),
+      windowStartUs(0), sleptUs(0), readings(0), lightSleeps(0), fireWakes(0),
+      fireWakesIgnored(0), wakeStartUs(0), wakePending(false), measuring(false),
+      wakeToSendUs(0), wakeToSendMaxUs(0) {}
+
+// Llamar desde setup() tras mesh.init(): la ISR notifica a la tarea actual
+void PowerManager::begin(uint8_t pin, uint32_t cpuMhz) {
+    firePin = pin;
+    loopTask = xTaskGetCurrentTaskHandle();
+    windowStartUs = esp_timer_get_time();
+
+    // El flanco de fuego fuerza una lectura también en el modo normal
+    attachInterrupt(digitalPinToInterrupt(pin), onFireEdge, RISING);
+
+    if (!enabled) return;
+
+    // 80 MHz es el mínimo con WiFi activo
+    setCpuFrequencyMhz(cpuMhz);
+
+    // Power-save del módem: solo afecta a la interfaz STA (el AP de la malla
+    // sigue emitiendo beacons mientras tenga nodos colgando)
+    esp_err_t err = esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+
+    LOG_I("[PWR] Sueño de nodo aislado: CPU %u MHz | idle máx %lu ms | módem PS %s",
+          getCpuFrequencyMhz(), idleMaxMs, err == ESP_OK ? "activo" : "no soportado");
+}
+
+// ========== IDLE: Dormir hasta el próximo deadline o un flanco de fuego ==========
+void PowerManager::idle(long nextDeadlineMs, bool isolated) {
+    if (!enabled || fireEdge) return;
+
+    unsigned long waitMs = nextDeadlineMs < 0 ? idleMaxMs : (unsigned long)nextDeadlineMs;
+    if (waitMs == 0) return;
+
+    int64_t start = esp_timer_get_time();
+
+    // En sueño ligero la radio no escucha: al quedarse aislado (y cada
+    // joinRetryMs) se mantiene despierta joinWindowMs para volver a la malla
+    unsigned long now = millis();
+    bool joining = false;
+    if (isolated) {
+        if (!wasIsolated || now - joinWindowStartMs >= joinRetryMs) {
+            joinWindowStartMs = now;
+            LOG_D("[PWR] Sin vecinos: ventana de unión de %lu ms", joinWindowMs);
+        }
+        joining = now - joinWindowStartMs < joinWindowMs;
+    }
+    wasIsolated = isolated;
+
+    // Sin vecinos no hay keep-alive que cumplir: sueño ligero hasta el deadline.
+    // Con la entrada de fuego ya activa el despertar por nivel sería inmediato.
+    if (isolated && !joining && waitMs >= lightSleepMinMs && digitalRead(firePin) == LOW) {
+        lightSleep(waitMs);
+    } else {
+        // Con vecinos se acota la espera: painlessMesh procesa sus mensajes y
+        // keep-alives en tareas del mismo scheduler que no vemos desde aquí
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(min(waitMs, idleMaxMs)));
+    }
+
+    sleptUs += esp_timer_get_time() - start;
+}
+
+void PowerManager::lightSleep(unsigned long ms) {
+    // La UART se detiene durante el sueño: vaciar antes los logs pendientes
+    Log::drain(LOG_RING_SIZE);
+    Serial.flush();
+
+    // El despertar por GPIO es por nivel; la interrupción por flanco se
+    // desactiva mientras tanto para no dispararse en bucle al despertar
+    gpio_num_t pin = (gpio_num_t)firePin;
+    gpio_intr_disable(pin);
+    gpio_wakeup_enable(pin, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000ULL);
+
+    esp_light_sleep_start();
+
+    gpio_wakeup_disable(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_POSEDGE);
+    gpio_intr_enable(pin);
+    lightSleeps++;
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        portENTER_CRITICAL(&fireMux);
+        if (!fireEdge) {
+            fireEdgeUs = micros();
+            fireEdge = true;
+        }
+        portEXIT_CRITICAL(&fireMux);
+    }
+}
+
+// ========== FUEGO: Despertar → lectura → envío ==========
+// true una vez por flanco: el llamador fuerza la lectura inmediata. Una
+// entrada que rebota u oscila no fuerza más de una lectura por fireWakeGapMs;
+// el tick normal sigue leyendo el pin.
+bool PowerManager::takeFireWake() {
+    if (!fireEdge) return false;
+
+    portENTER_CRITICAL(&fireMux);
+    uint32_t edgeUs = fireEdgeUs;
+    fireEdge = false;
+    portEXIT_CRITICAL(&fireMux);
+
+    unsigned long now = millis();
+    if (hasFireWake && now - lastFireWakeMs < fireWakeGapMs) {
+        fireWakesIgnored++;
+        return false;
+    }
+    hasFireWake = true;
+    lastFireWakeMs = now;
+
+    wakeStartUs = edgeUs;
+    wakePending = true;
+    fireWakes++;
+    return true;
+}
+
+void PowerManager::onReading() {
+    readings++;
+
+    // Solo la lectura forzada por el flanco mide la latencia; si no llega a
+    // enviarse (sin ROOT, en buffer) la medida se descarta en la siguiente
+    measuring = wakePending;
+    wakePending = false;
+}
+
+void PowerManager::onSent() {
+    if (!measuring) return;
+    measuring = false;
+
+    wakeToSendUs = micros() - wakeStartUs;
+    if (wakeToSendUs > wakeToSendMaxUs) wakeToSendMaxUs = wakeToSendUs;
+
+    LOG_I("[PWR] Fuego → lectura enviada en %lu us", (unsigned long)wakeToSendUs);
+}
+
+// ========== ESTADÍSTICAS POR VENTANA ==========
+PowerStats PowerManager::closeWindow() {
+    int64_t now = esp_timer_get_time();
+    uint64_t elapsed = now - windowStartUs;
+    uint64_t active = elapsed > sleptUs ? elapsed - sleptUs : 0;
+
+    PowerStats stats;
+    stats.windowMs = elapsed / 1000;
+    stats.dutyPermille = elapsed > 0 ? (uint32_t)(active * 1000 / elapsed) : 0;
+    stats.readings = readings;
+    stats.activeUsPerReading = readings > 0 ? (uint32_t)(active / readings) : 0;
+    stats.lightSleeps = lightSleeps;
+    stats.fireWakes = fireWakes;
+    stats.fireWakesIgnored = fireWakesIgnored;
+    stats.wakeToSendUs = wakeToSendUs;
+    stats.wakeToSendMaxUs = wakeToSendMaxUs;
+
+    windowStartUs = now;
+    sleptUs = 0;
+    readings = 0;
+    lightSleeps = 0;
+    fireWakes = 0;
+    fireWakesIgnored = 0;
+    wakeToSendMaxUs = 0;
+    return stats;
+}
+
+void PowerManager::fillJson(JsonObject obj, const PowerStats& stats) {
+    obj["duty"] = stats.dutyPermille;
+    obj["cpuRd"] = stats.activeUsPerReading;
+    obj["lps"] = stats.lightSleeps;
+    obj["w2s"] = stats.wakeToSendMaxUs;
+}
+
+void PowerManager::log(const PowerStats& stats) {
+    LOG_I("[PWR] CPU activa %u/1000 | %u us por lectura (%u lecturas) | %u sueños ligeros",
+          stats.dutyPermille, stats.activeUsPerReading, stats.readings, stats.lightSleeps);
+    if (stats.fireWakes > 0 || stats.fireWakesIgnored > 0) {
+        LOG_I("[PWR] %u despertares por fuego (%u ignorados por rebote) | fuego → envío máx %u us",
+              stats.fireWakes, stats.fireWakesIgnored, stats.wakeToSendMaxUs);
+    }
+}
@@ -0,0 +1,135 @@
+#include "PresenceManager.hpp"
+#include <ArduinoJson.h>
+#include <Firebase_ESP_Client.h>
+#include "Log.hpp"
+#include <algorithm>
+
+PresenceManager::PresenceManager(painlessMesh* meshInstance, unsigned long lastSeenRefreshMs)
+    : mesh(meshInstance), lastSeenRefreshMs(lastSeenRefreshMs), offlineCallback(nullptr) {}
+
+void PresenceManager::onOffline(void (*callback)(uint32_t nodeId)) {
+    offlineCallback = callback;
+}
+
+// Saltos desde el ROOT (-1 si el nodo no está en el árbol)
+int PresenceManager::depthOf(const painlessmesh::protocol::NodeTree& tree, uint32_t nodeId, int depth) {
+    if (tree.nodeId == nodeId) return depth;
+    for (auto& sub : tree.subs) {
+        int found = depthOf(sub, nodeId, depth + 1);
+        if (found >= 0) return found;
+    }
+    return -1;
+}
+
+void PresenceManager::markSeen(uint32_t nodeId) {
+    PresenceEntry& entry = table[nodeId];
+    unsigned long now = millis();
+    entry.lastSeen = now;
+
+    if (!entry.online) {
+        // Un mensaje de un nodo que creíamos caído lo trae de vuelta
+        entry.online = true;
+        entry.linkChanges++;
+        entry.dirty = true;
+    }
+    if (now - entry.lastPublished >= lastSeenRefreshMs) {
+        entry.dirty = true;
+    }
+}
+
+// Reconciliar con la vista de painlessMesh (conectividad y saltos)
+void PresenceManager::updateTopology() {
+    auto tree = mesh->asNodeTree();
+    auto nodes = mesh->getNodeList();
+
+    for (auto id : nodes) {
+        PresenceEntry& entry = table[id];
+        int hops = depthOf(tree, id, 0);
+
+        if (!entry.online) {
+            entry.online = true;
+            entry.linkChanges++;
+            entry.lastSeen = millis();
+            entry.dirty = true;
+            LOG_I("[PRES] Nodo %u online (%d saltos)", id, hops);
+        }
+        if (hops >= 0 && hops != entry.hops) {
+            entry.hops = hops;
+            entry.dirty = true;
+        }
+    }
+
+    for (auto& kv : table) {
+        if (!kv.second.online) continue;
+        if (std::find(nodes.begin(), nodes.end(), kv.first) != nodes.end()) continue;
+
+        kv.second.online = false;
+        kv.second.linkChanges++;
+        kv.second.dirty = true;
+        LOG_I("[PRES] Nodo %u offline", kv.first);
+        if (offlineCallback) offlineCallback(kv.first);
+    }
+}
+
+bool PresenceManager::hasChanges() {
+    for (auto& kv : table) {
+        if (kv.second.dirty) return true;
+    }
+    return false;
+}
+
+// Solo las entradas modificadas, como claves multi-ruta planas ("<id>/online").
+// FirebaseJson::set anida los "/" y el PATCH sustituiría /presencia/<id> entero,
+// borrando el lastSeen de un nodo caído: el parche se arma con ArduinoJson.
+bool PresenceManager::buildDelta(FirebaseJson& json) {
+    size_t dirty = 0;
+    for (auto& kv : table) {
+        if (kv.second.dirty) dirty++;
+    }
+    if (dirty == 0) return false;
+
+    // Por nodo: 4 claves copiadas (~20 caracteres) + el objeto {".sv": ...}
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(4 * dirty) + dirty * (JSON_OBJECT_SIZE(1) + 4 * 24));
+    unsigned long now = millis();
+    char key[24];
+
+    for (auto& kv : table) {
+        PresenceEntry& entry = kv.second;
+        if (!entry.dirty) continue;
+
+        snprintf(key, sizeof(key), "%u/online", kv.first);
+        doc[key] = entry.online;
+        snprintf(key, sizeof(key), "%u/hops", kv.first);
+        doc[key] = entry.hops;
+        snprintf(key, sizeof(key), "%u/links", kv.first);
+        doc[key] = entry.linkChanges;
+
+        // Hora real del servidor; un nodo caído conserva su último lastSeen
+        if (entry.online && now - entry.lastSeen < lastSeenRefreshMs) {
+            snprintf(key, sizeof(key), "%u/lastSeen", kv.first);
+            doc[key][".sv"] = "timestamp";
+        }
+    }
+
+    String payload;
+    serializeJson(doc, payload);
+    json.setJsonData(payload);
+    return true;
+}
+
+void PresenceManager::clearChanges() {
+    unsigned long now = millis();
+    for (auto& kv : table) {
+        if (!kv.second.dirty) continue;
+        kv.second.dirty = false;
+        kv.second.lastPublished = now;
+    }
+}
+
+size_t PresenceManager::onlineCount() {
+    size_t count = 0;
+    for (auto& kv : table) {
+        if (kv.second.online) count++;
+    }
+    return count;
+}
@@ -0,0 +1,148 @@
+#include "Profiler.hpp"
+
+#ifdef FIREMESH_PROFILER
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <xtensa/xtensa_context.h>
+
+// TCB en ejecución por núcleo (lo usa el propio port de FreeRTOS); leerlo
+// directamente evita llamar a código en flash desde la ISR
+extern "C" void* volatile pxCurrentTCB[];
+
+// Profundidad de interrupciones por núcleo (port.c); 1 = solo esta ISR
+extern "C" volatile uint32_t port_interruptNesting[];
+
+namespace Profiler {
+
+static const uint32_t SLOTS = 1u << PROF_SLOTS_BITS;
+static const int MAX_PROBE = 8;
+static const uint8_t PROF_TIMER = 3;
+
+struct Slot {
+    uint32_t pc;
+    uint32_t count;
+};
+
+struct TaskCount {
+    void* tcb;
+    uint32_t count;
+};
+
+static Slot slots[SLOTS];
+static TaskCount tasks[PROF_MAX_TASKS];
+static volatile uint32_t samples = 0;
+static volatile uint32_t dropped = 0;      // Histograma lleno en esa zona
+static volatile uint32_t otherTasks = 0;   // Más tareas que PROF_MAX_TASKS
+static volatile uint32_t nested = 0;       // Muestras dentro de otra ISR (sin PC fiable)
+static volatile bool running = false;
+static uint32_t startMs = 0;
+static uint32_t rate = PROF_HZ;
+static hw_timer_t* timer = nullptr;
+
+static void IRAM_ATTR onSample() {
+    if (!running) return;
+    samples++;
+
+    // EPC1 no sirve aquí: entre el vector y este callback corren el
+    // dispatcher de interrupciones y el del timer, y cualquier excepción de
+    // ventana lo pisa. _xt_lowint1 guarda antes el marco interrumpido
+    // (XtExcFrame) en la pila de la tarea y deja su dirección en
+    // pxTopOfStack, primer campo del TCB; solo si no hay anidamiento.
+    int core = xPortGetCoreID();
+    if (port_interruptNesting[core] > 1) {
+        nested++;
+        return;
+    }
+    void* tcb = pxCurrentTCB[core];
+    const XtExcFrame* frame = *(const XtExcFrame* const*)tcb;
+    uint32_t pc = frame->pc;
+
+    uint32_t idx = ((pc >> 2) * 2654435761u) >> (32 - PROF_SLOTS_BITS);
+    bool stored = false;
+    for (int probe = 0; probe < MAX_PROBE; probe++) {
+        Slot& slot = slots[(idx + probe) & (SLOTS - 1)];
+        if (slot.pc == pc || slot.pc == 0) {
+            slot.pc = pc;
+            slot.count++;
+            stored = true;
+            break;
+        }
+    }
+    if (!stored) dropped++;
+
+    for (int i = 0; i < PROF_MAX_TASKS; i++) {
+        if (tasks[i].tcb == tcb || tasks[i].tcb == nullptr) {
+            tasks[i].tcb = tcb;
+            tasks[i].count++;
+            return;
+        }
+    }
+    otherTasks++;
+}
+
+// Muestrea el núcleo que llama a begin() (core 1: loop, Firebase/TLS, mesh)
+void begin(uint32_t hz) {
+    rate = hz;
+    reset();
+
+    timer = timerBegin(PROF_TIMER, 80, true);  // 1 MHz
+    timerAttachInterrupt(timer, &onSample, true);
+    timerAlarmWrite(timer, 1000000UL / hz, true);
+    timerAlarmEnable(timer);
+
+    Serial.printf("[PROF] Muestreo a %lu Hz (%u bytes de histograma)\n",
+                  (unsigned long)hz, (unsigned)(sizeof(slots) + sizeof(tasks)));
+}
+
+void reset() {
+    running = false;
+    memset(slots, 0, sizeof(slots));
+    memset(tasks, 0, sizeof(tasks));
+    samples = 0;
+    dropped = 0;
+    otherTasks = 0;
+    nested = 0;
+    startMs = millis();
+    running = true;
+}
+
+// Formato de línea estable: lo parsea scripts/profile_report.py
+void dump(Print& out) {
+    running = false;
+
+    out.printf("PROF BEGIN hz=%lu samples=%lu dropped=%lu other=%lu nested=%lu ms=%lu\n",
+               (unsigned long)rate, (unsigned long)samples, (unsigned long)dropped,
+               (unsigned long)otherTasks, (unsigned long)nested,
+               (unsigned long)(millis() - startMs));
+
+    for (int i = 0; i < PROF_MAX_TASKS && tasks[i].tcb; i++) {
+        const char* name = pcTaskGetTaskName((TaskHandle_t)tasks[i].tcb);
+        out.printf("PROF T %s %lu\n", name ? name : "?", (unsigned long)tasks[i].count);
+    }
+    for (uint32_t i = 0; i < SLOTS; i++) {
+        if (slots[i].count == 0) continue;
+        out.printf("PROF P 0x%08lx %lu\n", (unsigned long)slots[i].pc,
+                   (unsigned long)slots[i].count);
+    }
+    out.println("PROF END");
+
+    running = true;
+}
+
+bool handleCommand(const char* line) {
+    if (strcmp(line, "prof") == 0) {
+        dump(Serial);
+        return true;
+    }
+    if (strcmp(line, "prof reset") == 0) {
+        reset();
+        Serial.println("[PROF] Histograma reiniciado");
+        return true;
+    }
+    return false;
+}
+
+}  // namespace Profiler
+
+#endif
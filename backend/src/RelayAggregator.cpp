@@ -0,0 +1,130 @@
+#include "RelayAggregator.hpp"
+#include "Log.hpp"
+
+RelayAggregator::RelayAggregator(painlessMesh* meshInstance, unsigned long windowMs, size_t maxEntries)
+    : mesh(meshInstance), windowMs(windowMs),
+      maxEntries(maxEntries < AGG_MAX_ENTRIES ? maxEntries : AGG_MAX_ENTRIES), firstPendingAt(0),
+      framesSent(0), entriesSent(0), framesMerged(0) {
+    pending.reserve(maxEntries);
+}
+
+bool RelayAggregator::treeContains(const painlessmesh::protocol::NodeTree& tree, uint32_t nodeId) {
+    if (tree.nodeId == nodeId) return true;
+    for (auto& sub : tree.subs) {
+        if (treeContains(sub, nodeId)) return true;
+    }
+    return false;
+}
+
+// Vecino directo cuya subárbol contiene al destino (0 si no hay ruta)
+uint32_t RelayAggregator::nextHopTo(uint32_t dest) {
+    auto tree = mesh->asNodeTree();
+    for (auto& sub : tree.subs) {
+        if (treeContains(sub, dest)) return sub.nodeId;
+    }
+    return 0;
+}
+
+// Hay tráfico que agregar si algún vecino directo no es el camino al ROOT
+bool RelayAggregator::hasDownstream(uint32_t root) {
+    auto tree = mesh->asNodeTree();
+    for (auto& sub : tree.subs) {
+        if (!treeContains(sub, root)) return true;
+    }
+    return false;
+}
+
+void RelayAggregator::add(uint32_t src, DataPacket data, bool urgent) {
+    if (pending.empty()) firstPendingAt = millis();
+
+    // Sin ruta al ROOT no se acumula indefinidamente: se pierde lo más antiguo
+    if (pending.size() >= maxEntries * 2) {
+        pending.erase(pending.begin());
+    }
+
+    AggEntry entry;
+    entry.src = src;
+    entry.data = data;
+    entry.urgent = urgent;
+    pending.push_back(entry);
+}
+
+// Incorpora un frame AGG recibido de un nodo aguas abajo
+void RelayAggregator::merge(JsonDocument& doc) {
+    JsonArray items = doc["items"];
+    bool urgent = doc["crit"] | false;
+    for (JsonArray item : items) {
+        DataPacket data;
+        data.timestamp = item[1];
+        data.humo = item[2];
+        data.fuego = item[3];
+        add(item[0], data, urgent);
+    }
+    framesMerged++;
+}
+
+bool RelayAggregator::isDue() {
+    if (pending.empty()) return false;
+    if (pending.size() >= maxEntries || millis() - firstPendingAt >= windowMs) return true;
+
+    // Las lecturas críticas no esperan a que cierre la ventana
+    for (auto& entry : pending) {
+        if (entry.urgent) return true;
+    }
+    return false;
+}
+
+bool RelayAggregator::flush(uint32_t root) {
+    if (pending.empty()) return true;
+
+    uint32_t hop = nextHopTo(root);
+    if (hop == 0) return false;
+
+    // Frames de a lo sumo maxEntries lecturas: [src, ts, humo, fuego]
+    size_t offset = 0;
+    while (offset < pending.size()) {
+        size_t count = pending.size() - offset;
+        if (count > maxEntries) count = maxEntries;
+
+        DynamicJsonDocument doc(JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(count) +
+                                count * JSON_ARRAY_SIZE(4) + 32);
+        doc["type"] = "AGG";
+        doc["src"] = mesh->getNodeId();
+        JsonArray items = doc.createNestedArray("items");
+        bool urgent = false;
+        for (size_t i = offset; i < offset + count; i++) {
+            urgent = urgent || pending[i].urgent;
+            JsonArray item = items.createNestedArray();
+            item.add(pending[i].src);
+            item.add(pending[i].data.timestamp);
+            item.add(pending[i].data.humo);
+            item.add(pending[i].data.fuego);
+        }
+        if (urgent) doc["crit"] = true;
+
+        String msg;
+        msg.reserve(measureJson(doc) + 1);
+        serializeJson(doc, msg);
+        mesh->sendSingle(hop, msg);
+
+        framesSent++;
+        entriesSent += count;
+        offset += count;
+    }
+
+    LOG_D("[AGG] %u lecturas → nodo %u", (unsigned)pending.size(), hop);
+    pending.clear();
+    return true;
+}
+
+uint32_t RelayAggregator::getFramesSent() {
+    return framesSent;
+}
+
+uint32_t RelayAggregator::getEntriesSent() {
+    return entriesSent;
+}
+
+uint32_t RelayAggregator::getFramesMerged() {
+    return framesMerged;
+}
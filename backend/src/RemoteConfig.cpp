@@ -0,0 +1,160 @@
+#include "RemoteConfig.hpp"
+#include "Log.hpp"
+#include <Preferences.h>
+
+// Cotas de seguridad: una config errónea no debe dejar un nodo inservible
+static const unsigned long MIN_SENSOR_MS = 500;
+static const unsigned long MIN_SYNC_MS = 2000;
+static const unsigned long MIN_STATUS_MS = 10000;
+static const int MAX_BUFFER_SIZE = 2000;
+
+RemoteConfig::RemoteConfig(const NodeConfig& defaults, const char* group)
+    : current(defaults), group(group) {}
+
+bool RemoteConfig::isTargeted(JsonVariantConst doc, uint32_t nodeId) {
+    JsonArrayConst nodes = doc["nodes"];
+    const char* targetGroup = doc["group"] | "";
+
+    // Sin destino explícito: toda la flota
+    if (nodes.isNull() && targetGroup[0] == '\0') return true;
+
+    if (!nodes.isNull()) {
+        for (JsonVariantConst id : nodes) {
+            if (id.as<uint32_t>() == nodeId) return true;
+        }
+    }
+    return targetGroup[0] != '\0' && group == targetGroup;
+}
+
+bool RemoteConfig::load(const String& json, String& message) {
+    StaticJsonDocument<512> src;
+    if (deserializeJson(src, json)) {
+        LOG_E("[CFG] Documento de configuración inválido");
+        return false;
+    }
+
+    uint32_t version = src["v"] | 0;
+    if (version <= current.version) {
+        LOG_D("[CFG] Versión %u ya aplicada (actual %u)", version, current.version);
+        return false;
+    }
+
+    StaticJsonDocument<128> dest;
+    if (!src["nodes"].isNull()) dest["nodes"] = src["nodes"];
+    if (!src["group"].isNull()) dest["group"] = src["group"];
+    String target;
+    if (!dest.isNull()) serializeJson(dest, target);
+
+    StaticJsonDocument<512> out;
+    out["type"] = "CFG";
+    out["v"] = version;
+    out["set"] = src["set"];
+    if (!src["nodes"].isNull()) out["nodes"] = src["nodes"];
+    if (!src["group"].isNull()) out["group"] = src["group"];
+
+    message = "";
+    serializeJson(out, message);
+
+    compact(target, src["set"]);
+    if (history.size() >= CONFIG_HISTORY_MAX) {
+        LOG_W("[CFG] Historial lleno: se descarta la versión %u", history.front().version);
+        history.erase(history.begin());
+    }
+    ConfigMessage entry = {version, target, message};
+    history.push_back(entry);
+
+    current.version = version;
+    LOG_I("[CFG] Versión %u lista para difundir (%u bytes, %u en historial)",
+          version, (unsigned)message.length(), (unsigned)history.size());
+    return true;
+}
+
+// Las claves que reescribe un CFG nuevo salen de los anteriores con el mismo
+// destino: para esos nodos el valor final es el mismo y el historial no crece
+void RemoteConfig::compact(const String& target, JsonObjectConst set) {
+    for (size_t i = 0; i < history.size();) {
+        ConfigMessage& entry = history[i];
+        if (entry.target != target) {
+            i++;
+            continue;
+        }
+
+        StaticJsonDocument<512> doc;
+        deserializeJson(doc, entry.message);
+        JsonObject prev = doc["set"];
+        for (JsonPairConst kv : set) prev.remove(kv.key().c_str());
+
+        if (prev.size() == 0) {
+            history.erase(history.begin() + i);
+            continue;
+        }
+        entry.message = "";
+        serializeJson(doc, entry.message);
+        i++;
+    }
+}
+
+size_t RemoteConfig::messageCount() {
+    return history.size();
+}
+
+const String& RemoteConfig::getMessage(size_t index) {
+    return history[index].message;
+}
+
+bool RemoteConfig::apply(JsonDocument& doc, uint32_t nodeId) {
+    uint32_t version = doc["v"] | 0;
+    if (version <= current.version) return false;
+
+    if (!isTargeted(doc.as<JsonVariantConst>(), nodeId)) {
+        LOG_D("[CFG] Versión %u no dirigida a este nodo", version);
+        return false;
+    }
+
+    JsonObjectConst set = doc["set"];
+    NodeConfig next = current;
+    next.version = version;
+    next.sensorMs = max(MIN_SENSOR_MS, set["sensorMs"] | current.sensorMs);
+    next.syncMs = max(MIN_SYNC_MS, set["syncMs"] | current.syncMs);
+    next.statusMs = max(MIN_STATUS_MS, set["statusMs"] | current.statusMs);
+    next.bufferSize = constrain(set["buffer"] | current.bufferSize, 1, MAX_BUFFER_SIZE);
+    next.smokeCritical = set["smoke"] | current.smokeCritical;
+
+    current = next;
+    persist();
+    LOG_I("[CFG] v%u aplicada: muestreo %lu ms | sync %lu ms | estado %lu ms",
+          version, current.sensorMs, current.syncMs, current.statusMs);
+    LOG_I("[CFG] Buffer %d lecturas | umbral humo %d", current.bufferSize, current.smokeCritical);
+    return true;
+}
+
+bool RemoteConfig::restore() {
+    Preferences prefs;
+    if (!prefs.begin("cfg", true)) return false;
+
+    NodeConfig stored;
+    bool ok = prefs.getBytesLength("node") == sizeof(stored) &&
+              prefs.getBytes("node", &stored, sizeof(stored)) == sizeof(stored);
+    prefs.end();
+    if (!ok || stored.version <= current.version) return false;
+
+    current = stored;
+    LOG_I("[CFG] v%u restaurada de NVS", current.version);
+    return true;
+}
+
+// Solo tras aplicar una versión nueva: pocas escrituras de flash
+void RemoteConfig::persist() {
+    Preferences prefs;
+    if (!prefs.begin("cfg", false)) return;
+    prefs.putBytes("node", &current, sizeof(current));
+    prefs.end();
+}
+
+const NodeConfig& RemoteConfig::get() {
+    return current;
+}
+
+uint32_t RemoteConfig::getVersion() {
+    return current.version;
+}
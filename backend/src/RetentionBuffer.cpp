@@ -0,0 +1,77 @@
+#include "RetentionBuffer.hpp"
+#include <algorithm>
+
+RetentionBuffer::RetentionBuffer(size_t maxSize)
+    : maxSize(maxSize), compactions(0) {}
+
+bool RetentionBuffer::push(const DataPacket& data) {
+    buffer.push_back(data);
+    if (buffer.size() <= maxSize || compact()) return true;
+
+    buffer.pop_front();
+    return false;
+}
+
+// Ajuste en caliente (config remota): recortar por lo más antiguo
+void RetentionBuffer::setMaxSize(size_t size) {
+    maxSize = size;
+    while (buffer.size() > maxSize) {
+        if (!compact()) buffer.pop_front();
+    }
+}
+
+// Compactar la ventana más antigua del nivel más fino disponible. La mitad
+// reciente del buffer nunca se toca: conserva resolución completa.
+bool RetentionBuffer::compact() {
+    size_t limit = buffer.size() / 2;
+
+    for (uint8_t tier = 0; tier <= RETENTION_MAX_TIER; tier++) {
+        size_t run = 0;
+        for (size_t i = 0; i < limit; i++) {
+            run = (buffer[i].tier <= tier) ? run + 1 : 0;
+            if (run < RETENTION_WINDOW) continue;
+
+            if (reduceWindow(i + 1 - RETENTION_WINDOW, tier)) {
+                compactions++;
+                return true;
+            }
+            run = 0;  // Ventana irreducible (solo flancos de llama)
+        }
+    }
+    return false;
+}
+
+bool RetentionBuffer::reduceWindow(size_t start, uint8_t tier) {
+    size_t end = start + RETENTION_WINDOW;
+
+    size_t lo = start, hi = start;
+    for (size_t i = start; i < end; i++) {
+        if (buffer[i].humo < buffer[lo].humo) lo = i;
+        if (buffer[i].humo > buffer[hi].humo) hi = i;
+    }
+
+    DataPacket kept[RETENTION_WINDOW];
+    size_t n = 0;
+    for (size_t i = start; i < end; i++) {
+        bool edge = i > 0 && buffer[i].fuego != buffer[i - 1].fuego;
+        // La primera lectura del buffer marca el inicio del corte: se conserva
+        if (i == 0 || i == lo || i == hi || i == end - 1 || edge) {
+            kept[n] = buffer[i];
+            kept[n].tier = std::min<uint8_t>(tier + 1, RETENTION_MAX_TIER);
+            n++;
+        }
+    }
+    if (n >= RETENTION_WINDOW) return false;
+
+    buffer.erase(buffer.begin() + start, buffer.begin() + end);
+    buffer.insert(buffer.begin() + start, kept, kept + n);
+    return true;
+}
+
+// Intervalo de tiempo cubierto por el buffer (ms de hora de red)
+unsigned long long RetentionBuffer::getCoverage() const {
+    if (buffer.size() < 2) return 0;
+    unsigned long long first = buffer.front().timestamp;
+    unsigned long long last = buffer.back().timestamp;
+    return (first > 0 && last > first) ? last - first : 0;
+}
@@ -0,0 +1,116 @@
+#include "SnapshotAssembler.hpp"
+#include "Log.hpp"
+
+SnapshotAssembler::SnapshotAssembler(unsigned long deadlineMs, size_t maxOpen)
+    : closedNext(0), deadlineMs(deadlineMs), maxOpen(maxOpen), callback(nullptr),
+      lastClosedTs(0), lastReporters(0), closedComplete(0), closedDeadline(0), lateEntries(0) {
+    memset(closed, 0, sizeof(closed));
+}
+
+void SnapshotAssembler::onSnapshot(SnapshotCallback cb) {
+    callback = cb;
+}
+
+bool SnapshotAssembler::wasClosed(unsigned long long ts) {
+    for (int i = 0; i < SNAPSHOT_CLOSED_MEMORY; i++) {
+        if (closed[i] == ts) return true;
+    }
+    return false;
+}
+
+void SnapshotAssembler::add(uint32_t nodeId, unsigned long long ts, int humo, int fuego) {
+    SnapshotEntry entry = {nodeId, humo, (uint8_t)(fuego ? 1 : 0)};
+
+    for (size_t i = 0; i < open.size(); i++) {
+        if (open[i].ts != ts) continue;
+
+        // Reenvío del mismo nodo (reintento de la malla): no cuenta dos veces
+        for (SnapshotEntry& prev : open[i].entries) {
+            if (prev.nodeId == nodeId) {
+                prev = entry;
+                return;
+            }
+        }
+
+        open[i].entries.push_back(entry);
+        if (open[i].late) {
+            lateEntries++;
+            if (ts == lastClosedTs) lastReporters++;  // Nodo nuevo: esperarlo el próximo tick
+        }
+        if (!open[i].late && open[i].expected > 0 && open[i].entries.size() >= open[i].expected) {
+            close(i, true);
+        }
+        return;
+    }
+
+    // Demasiados ticks abiertos (relojes desalineados): cerrar el más antiguo
+    if (open.size() >= maxOpen) {
+        size_t oldest = 0;
+        for (size_t i = 1; i < open.size(); i++) {
+            if (open[i].ts < open[oldest].ts) oldest = i;
+        }
+        close(oldest, false);
+    }
+
+    FleetSnapshot snapshot;
+    snapshot.ts = ts;
+    snapshot.expected = lastReporters;
+    snapshot.late = wasClosed(ts);
+    snapshot.entries.push_back(entry);
+    if (snapshot.late) {
+        lateEntries++;
+        if (ts == lastClosedTs) lastReporters++;
+    }
+    open.push_back(snapshot);
+
+    if (!snapshot.late && snapshot.expected == 1) close(open.size() - 1, true);
+}
+
+// Cerrar por plazo los ticks incompletos
+void SnapshotAssembler::poll(unsigned long long now) {
+    for (size_t i = 0; i < open.size();) {
+        if (now >= open[i].ts + deadlineMs) {
+            close(i, false);
+        } else {
+            i++;
+        }
+    }
+}
+
+void SnapshotAssembler::close(size_t index, bool complete) {
+    FleetSnapshot& snapshot = open[index];
+
+    if (!snapshot.late) {
+        closed[closedNext] = snapshot.ts;
+        closedNext = (closedNext + 1) % SNAPSHOT_CLOSED_MEMORY;
+
+        // Referencia del siguiente tick; uno antiguo cerrado por desborde no la pisa
+        if (snapshot.ts >= lastClosedTs) {
+            lastClosedTs = snapshot.ts;
+            lastReporters = snapshot.entries.size();
+        }
+
+        if (complete) {
+            closedComplete++;
+        } else {
+            closedDeadline++;
+            LOG_D("[SNAP] Tick %llu cerrado por plazo (%u/%u nodos)", snapshot.ts,
+                  (unsigned)snapshot.entries.size(), (unsigned)snapshot.expected);
+        }
+    }
+
+    if (callback) callback(snapshot);
+    open.erase(open.begin() + index);
+}
+
+uint32_t SnapshotAssembler::getClosedComplete() {
+    return closedComplete;
+}
+
+uint32_t SnapshotAssembler::getClosedDeadline() {
+    return closedDeadline;
+}
+
+uint32_t SnapshotAssembler::getLateEntries() {
+    return lateEntries;
+}
@@ -1,9 +1,51 @@
 #include "SyncManager.hpp"
+#include "Log.hpp"
+#include "HistoryCodec.hpp"
+#include <algorithm>
+#include <Preferences.h>
+#include <esp32/rtc.h>
+#include <rom/crc.h>
 
-SyncManager::SyncManager(painlessMesh* meshInstance, int maxBuffer)
+// Peso de cada beacon nuevo sobre el offset actual (filtro exponencial)
+static const double BEACON_GAIN = 0.25;
+
+// Un error mayor indica un salto (ROOT reiniciado o estado restaurado erróneo)
+static const double STEP_THRESHOLD_MS = 500.0;
+
+// Intervalo mínimo entre calibraciones para estimar la deriva
+static const unsigned long DRIFT_MIN_INTERVAL_MS = 30000;
+
+// Antigüedad máxima del estado RTC para reanudar sin esperar al ROOT
+static const unsigned long long WARM_MAX_AGE_US = 300000000ULL;
+
+static const uint32_t SYNC_STATE_MAGIC = 0x46534E43;  // "FSNC"
+
+// Sobrevive a reinicios por software/watchdog, no a un corte de alimentación
+struct SyncSnapshot {
+    uint32_t magic;
+    uint32_t rootId;
+    uint64_t rtcUs;       // esp_rtc_get_time_us() al guardar
+    uint64_t networkMs;   // hora de red en ese mismo instante
+    double pathDelay;
+    double driftPpm;
+    uint32_t crc;
+};
+
+RTC_DATA_ATTR static SyncSnapshot rtcSnapshot;
+
+static uint32_t snapshotCrc(const SyncSnapshot& snap) {
+    return crc32_le(0, (const uint8_t*)&snap, offsetof(SyncSnapshot, crc));
+}
+
+SyncManager::SyncManager(painlessMesh* meshInstance, int maxBuffer, int calibrationEvery)
     : mesh(meshInstance), timeOffset(0.0), isSynchronized(false), 
-      rootNodeId(0), maxBufferSize(maxBuffer) {
-    offlineBuffer = new std::deque<DataPacket>();
+      rootNodeId(0),
+      pathDelay(0.0), isCalibrated(false), beaconsSinceCalibration(0),
+      calibrationEvery(calibrationEvery), lastBeaconError(0.0), congestionLevel(0),
+      syncMessagesSent(0), slotIndex(-1), slotCount(0),
+      driftPpm(0.0), lastCalibrationMs(0), lastCalibrationOffset(0.0),
+      warmStart(false) {
+    offlineBuffer = new RetentionBuffer(maxBuffer);
 }
 
 double SyncManager::getTimeOffset() {
@@ -22,6 +64,57 @@ unsigned long long SyncManager::getNetworkTime() {
     return (unsigned long long)millis() + (long long)timeOffset;
 }
 
+double SyncManager::getPathDelay() {
+    return pathDelay;
+}
+
+double SyncManager::getLastBeaconError() {
+    return lastBeaconError;
+}
+
+uint32_t SyncManager::takeSyncMessageCount() {
+    uint32_t count = syncMessagesSent;
+    syncMessagesSent = 0;
+    return count;
+}
+
+uint8_t SyncManager::getCongestionLevel() {
+    return congestionLevel;
+}
+
+bool SyncManager::hasSlot() {
+    return slotIndex >= 0 && slotCount > 0 && isSynchronized;
+}
+
+// Milisegundos hasta el próximo tick global (múltiplo del periodo en hora de red)
+unsigned long SyncManager::getTickDelay(unsigned long period) {
+    unsigned long now = (unsigned long)(getNetworkTime() % period);
+    return (period - now) % period;
+}
+
+// Retraso de transmisión tras el tick: el slot propio dentro del periodo
+unsigned long SyncManager::getSlotOffset(unsigned long period) {
+    if (!hasSlot()) return 0;
+    return (unsigned long)(((unsigned long long)slotIndex * period) / slotCount);
+}
+
+// Redondear al tick más cercano si el muestreo cayó dentro de la tolerancia
+unsigned long long SyncManager::snapToTick(unsigned long long ts, unsigned long period,
+                                           unsigned long tolerance) {
+    if (ts == 0) return 0;
+    unsigned long long tick = ((ts + period / 2) / period) * period;
+    unsigned long long diff = ts > tick ? ts - tick : tick - ts;
+    return diff <= tolerance ? tick : ts;
+}
+
+double SyncManager::getDriftPpm() {
+    return driftPpm;
+}
+
+bool SyncManager::isWarmStart() {
+    return warmStart;
+}
+
 void SyncManager::setTimeOffset(double offset) {
     timeOffset = offset;
 }
@@ -31,20 +124,42 @@ void SyncManager::setSyncStatus(bool status) {
 }
 
 void SyncManager::setRootId(uint32_t id) {
+    if (id != rootNodeId) {
+        // La latencia medida y el slot pertenecen al ROOT anterior
+        isCalibrated = false;
+        slotIndex = -1;
+        lastCalibrationMs = 0;
+        persistRootId(id);
+    }
     rootNodeId = id;
-    Serial.printf("[Sync] Root ID establecido: %u\n", id);
+    LOG_I("[Sync] Root ID establecido: %u", id);
+}
+
+// Ajuste en caliente (config remota): recortar por lo más antiguo
+void SyncManager::setMaxBufferSize(int size) {
+    offlineBuffer->setMaxSize(size);
 }
 
 void SyncManager::addToBuffer(DataPacket data) {
-    offlineBuffer->push_back(data);
-    
-    if (offlineBuffer->size() > maxBufferSize) {
-        offlineBuffer->pop_front();
-        Serial.println("[Buffer] Memoria llena. Borrando dato más antiguo.");
+    // Lleno: degradar lo antiguo antes que perderlo
+    if (!offlineBuffer->push(data)) {
+        LOG_W("[Buffer] Memoria llena. Borrando dato más antiguo.");
     }
     
-    Serial.printf("[Buffer] Datos guardados. Buffer: %d/%d\n", 
-                  offlineBuffer->size(), maxBufferSize);
+    LOG_D("[Buffer] Datos guardados. Buffer: %d/%d", 
+          offlineBuffer->size(), offlineBuffer->getMaxSize());
+}
+
+size_t SyncManager::getBufferedCount() {
+    return offlineBuffer->size();
+}
+
+unsigned long long SyncManager::getBufferCoverage() {
+    return offlineBuffer->getCoverage();
+}
+
+uint32_t SyncManager::getCompactions() {
+    return offlineBuffer->getCompactions();
 }
 
 bool SyncManager::hasBufferedData() {
@@ -54,17 +169,59 @@ bool SyncManager::hasBufferedData() {
 void SyncManager::flushBuffer(void (*sendCallback)(DataPacket, String)) {
     if (offlineBuffer->empty()) return;
     
-    Serial.println("\nRECONEXIÓN: Vaciando memoria (Burst)...");
+    LOG_I("RECONEXIÓN: Vaciando memoria (Burst)...");
     while (!offlineBuffer->empty()) {
         DataPacket saved = offlineBuffer->front();
         sendCallback(saved, "DATA_HIST");
         
-        Serial.printf(">> RECUPERADO: humo=%d, fuego=%d (TS: %llu)\n", 
-                     saved.humo, saved.fuego, saved.timestamp);
+        LOG_D(">> RECUPERADO: humo=%d, fuego=%d (TS: %llu)", 
+              saved.humo, saved.fuego, saved.timestamp);
         offlineBuffer->pop_front();
         delay(50);
     }
-    Serial.println("Memoria vaciada.\n");
+    LOG_I("Memoria vaciada.");
+}
+
+// Backfill comprimido: un mensaje DATA_BLK por cada bloque de hasta blockSamples.
+// maxBlocks > 0 limita el envío a la ventana concedida por el ROOT.
+int SyncManager::flushBufferBlocks(void (*sendRaw)(const String&), size_t blockSamples, int maxBlocks) {
+    if (offlineBuffer->empty()) return 0;
+    // Un bloque de 0 lecturas nunca acepta la primera y el bucle no avanzaría
+    if (blockSamples == 0) blockSamples = 1;
+
+    LOG_D("[Buffer] Enviando historial en bloques (%u lecturas)...",
+          (unsigned)offlineBuffer->size());
+    HistoryEncoder encoder(blockSamples);
+    uint32_t nodeId = mesh->getNodeId();
+    int blocks = 0;
+
+    while (!offlineBuffer->empty()) {
+        DataPacket saved = offlineBuffer->front();
+
+        // Lecturas sin hora de red no tienen base para el delta-of-delta
+        if (saved.timestamp == 0) {
+            sendRaw(createDataJSON(saved, "DATA_HIST", nodeId));
+            offlineBuffer->pop_front();
+            continue;
+        }
+
+        if (!encoder.add(saved)) {
+            sendRaw(createBlockJSON(encoder, nodeId));
+            encoder.reset();
+            blocks++;
+            if (maxBlocks > 0 && blocks >= maxBlocks) return blocks;
+            delay(50);
+            continue;  // Reintentar la misma lectura en un bloque nuevo
+        }
+        offlineBuffer->pop_front();
+    }
+
+    if (encoder.count() > 0) {
+        sendRaw(createBlockJSON(encoder, nodeId));
+        blocks++;
+    }
+    LOG_D("[Buffer] Historial enviado en %d bloques.", blocks);
+    return blocks;
 }
 
 String SyncManager::createDataJSON(DataPacket data, String tipo, uint32_t nodeId) {
@@ -77,18 +234,146 @@ String SyncManager::createDataJSON(DataPacket data, String tipo, uint32_t nodeId
     body["humo"] = data.humo;
     body["fuego"] = data.fuego;
     
+    // Reservar de una vez para evitar realocaciones al serializar
     String output;
+    output.reserve(measureJson(doc) + 1);
     serializeJson(doc, output);
     return output;
 }
 
-void SyncManager::handleSyncRequest(uint32_t from) {
+// Conserva el slot de los nodos que siguen y reutiliza los huecos de los que salen
+void SyncManager::updateSlots(const std::list<uint32_t>& nodes) {
+    for (auto& slot : slotOrder) {
+        if (std::find(nodes.begin(), nodes.end(), slot) == nodes.end()) slot = 0;
+    }
+    for (auto id : nodes) {
+        if (std::find(slotOrder.begin(), slotOrder.end(), id) != slotOrder.end()) continue;
+
+        auto hole = std::find(slotOrder.begin(), slotOrder.end(), 0u);
+        if (hole != slotOrder.end()) *hole = id;
+        else slotOrder.push_back(id);
+    }
+    while (!slotOrder.empty() && slotOrder.back() == 0) slotOrder.pop_back();
+}
+
+String SyncManager::createSyncBeacon(uint8_t congestion) {
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(slotOrder.size()) + 64);
+    doc["type"] = "SYNC";
+    doc["root"] = mesh->getNodeId();
+    doc["ts"] = (unsigned long long)millis();
+    if (congestion > 0) doc["cong"] = congestion;
+
+    // Posición en el arreglo = slot; 0 marca un slot libre
+    if (!slotOrder.empty()) {
+        JsonArray slots = doc.createNestedArray("slots");
+        for (auto id : slotOrder) slots.add(id);
+    }
+
+    String msg;
+    serializeJson(doc, msg);
+    syncMessagesSent++;
+    return msg;
+}
+
+// Capacidad para parsear msg: cada valor va tras ',', '[' o '{' (cota superior),
+// más la copia de las cadenas. El beacon SYNC crece con la tabla de slots.
+size_t SyncManager::docCapacityFor(const String& msg) {
+    size_t values = 1;
+    for (size_t i = 0; i < msg.length(); i++) {
+        char c = msg[i];
+        if (c == ',' || c == '[' || c == '{') values++;
+    }
+    return JSON_ARRAY_SIZE(values) + msg.length() + 1;
+}
+
+void SyncManager::handleSyncBeacon(JsonDocument& doc) {
+    congestionLevel = doc["cong"] | 0;
+
+    JsonArray slots = doc["slots"];
+    if (!slots.isNull()) {
+        uint32_t self = mesh->getNodeId();
+        slotIndex = -1;
+        slotCount = slots.size();
+        for (int i = 0; i < slotCount; i++) {
+            if (slots[i].as<uint32_t>() == self) slotIndex = i;
+        }
+    }
+
+    if (doc["ts"].isNull()) return;
+
+    beaconsSinceCalibration++;
+
+    // Sin latencia medida el beacon llega con un retraso desconocido
+    if (!isCalibrated) return;
+
+    unsigned long long rootTs = doc["ts"];
+    double estimate = (double)rootTs + pathDelay - (double)millis();
+
+    if (!isSynchronized) {
+        timeOffset = estimate;
+        isSynchronized = true;
+        lastBeaconError = 0.0;
+        return;
+    }
+
+    lastBeaconError = estimate - timeOffset;
+    if (fabs(lastBeaconError) > STEP_THRESHOLD_MS) {
+        LOG_W("[Sync] Salto de %.0f ms en la hora de red, reajustando", lastBeaconError);
+        timeOffset = estimate;
+    } else {
+        timeOffset += BEACON_GAIN * lastBeaconError;
+    }
+    saveState();
+}
+
+bool SyncManager::needsCalibration() {
+    return !isCalibrated || beaconsSinceCalibration >= calibrationEvery;
+}
+
+String SyncManager::createSyncRequest() {
+    StaticJsonDocument<128> doc;
+    doc["type"] = "TIME";
+    doc["src"] = mesh->getNodeId();
+    doc["T1"] = (unsigned long long)millis();
+
+    String msg;
+    serializeJson(doc, msg);
+    return msg;
+}
+
+String SyncManager::createBlockJSON(HistoryEncoder& encoder, uint32_t nodeId) {
+    // Con timestamps irregulares el base64 pasa de 300 caracteres: el
+    // documento se dimensiona con el bloque (blk se copia al pool)
+    String blk = encoder.toBase64();
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(3) + JSON_OBJECT_SIZE(4) + blk.length() + 1);
+    doc["type"] = "DATA_BLK";
+    doc["src"] = nodeId;
+
+    JsonObject body = doc.createNestedObject("body");
+    body["t0"] = encoder.getFirstTs();
+    body["t1"] = encoder.getLastTs();
+    body["n"] = encoder.count();
+    body["blk"] = blk;
+
+    String output;
+    output.reserve(measureJson(doc) + 1);
+    serializeJson(doc, output);
+
+    LOG_D("[Buffer] Bloque %u lecturas → %u bytes",
+          (unsigned)encoder.count(), (unsigned)encoder.encodedSize());
+    return output;
+}
+
+void SyncManager::handleSyncRequest(uint32_t from, JsonDocument& doc) {
+    unsigned long long T2 = millis();
+
     StaticJsonDocument<256> res;
     res["type"] = "TIME";
     res["src"] = mesh->getNodeId();
 
     JsonObject body = res.createNestedObject("body");
-    body["T2"] = (unsigned long long)millis();
+    body["T1"] = doc["T1"].as<unsigned long long>();
+    body["T2"] = T2;
     body["T3"] = (unsigned long long)millis();
 
     String resMsg;
@@ -96,24 +381,118 @@ void SyncManager::handleSyncRequest(uint32_t from) {
 
     // painlessMesh hace routing automático multi-hop
     mesh->sendSingle(from, resMsg);
+    syncMessagesSent++;
 
-    Serial.printf("[Sync] Enviando T2,T3 hacia nodo %u (auto-multihop)\n", from);
+    LOG_D("[Sync] Enviando T2,T3 hacia nodo %u (auto-multihop)", from);
 }
 
 
 void SyncManager::handleSyncResponse(JsonDocument& doc) {
     if (doc["body"].isNull()) {
-        Serial.println("[Sync] Error: 'body' no presente en TIME");
+        LOG_E("[Sync] Error: 'body' no presente en TIME");
         return;
     }
     
-    unsigned long long T2 = doc["body"]["T2"];
-    unsigned long long T3 = doc["body"]["T3"];
-    unsigned long long T1 = millis();
-    unsigned long long T4 = millis();
+    // Respuesta de un ROOT sin T1 (firmware antiguo): no se puede calibrar
+    if (doc["body"]["T1"].isNull()) return;
+
+    long long T1 = doc["body"]["T1"];
+    long long T2 = doc["body"]["T2"];
+    long long T3 = doc["body"]["T3"];
+    long long T4 = millis();
     
     double offset = ((double)(T2 - T1) + (double)(T3 - T4)) / 2.0;
+
+    // Deriva: cambio del offset entre dos calibraciones independientes
+    unsigned long elapsed = (unsigned long)T4 - lastCalibrationMs;
+    if (lastCalibrationMs != 0 && elapsed >= DRIFT_MIN_INTERVAL_MS) {
+        double measured = (offset - lastCalibrationOffset) * 1e6 / elapsed;
+        driftPpm = (driftPpm == 0.0) ? measured : 0.7 * driftPpm + 0.3 * measured;
+    }
+    if (lastCalibrationMs == 0 || elapsed >= DRIFT_MIN_INTERVAL_MS) {
+        lastCalibrationMs = (unsigned long)T4;
+        lastCalibrationOffset = offset;
+    }
+
     timeOffset = offset;
+    pathDelay = ((double)(T4 - T1) - (double)(T3 - T2)) / 2.0;
     isSynchronized = true;
-    Serial.printf("[NTP] Sincronizado. Offset: %.2f ms\n", timeOffset);
+    isCalibrated = true;
+    beaconsSinceCalibration = 0;
+    LOG_I("[NTP] Calibrado. Offset: %.2f ms | Latencia: %.2f ms | Deriva: %.1f ppm",
+          timeOffset, pathDelay, driftPpm);
+    saveState();
+}
+
+// ========== ARRANQUE EN CALIENTE ==========
+void SyncManager::persistRootId(uint32_t id) {
+    // Solo se escribe flash cuando cambia el ROOT, nunca al perderlo
+    if (id == 0) return;
+
+    Preferences prefs;
+    if (!prefs.begin("sync", false)) return;
+    if (prefs.getUInt("root", 0) != id) {
+        prefs.putUInt("root", id);
+    }
+    prefs.end();
+}
+
+void SyncManager::saveState() {
+    if (!isSynchronized || rootNodeId == 0) return;
+
+    rtcSnapshot.magic = SYNC_STATE_MAGIC;
+    rtcSnapshot.rootId = rootNodeId;
+    rtcSnapshot.rtcUs = esp_rtc_get_time_us();
+    rtcSnapshot.networkMs = getNetworkTime();
+    rtcSnapshot.pathDelay = pathDelay;
+    rtcSnapshot.driftPpm = driftPpm;
+    rtcSnapshot.crc = snapshotCrc(rtcSnapshot);
+}
+
+bool SyncManager::restoreState() {
+    Preferences prefs;
+    uint32_t storedRoot = 0;
+    if (prefs.begin("sync", true)) {
+        storedRoot = prefs.getUInt("root", 0);
+        prefs.end();
+    }
+
+    // Tras un corte de alimentación el contador RTC vuelve a cero
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool rtcValid = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT &&
+                    rtcSnapshot.magic == SYNC_STATE_MAGIC &&
+                    rtcSnapshot.crc == snapshotCrc(rtcSnapshot);
+
+    uint64_t nowUs = esp_rtc_get_time_us();
+    if (rtcValid && (nowUs < rtcSnapshot.rtcUs || nowUs - rtcSnapshot.rtcUs > WARM_MAX_AGE_US)) {
+        rtcValid = false;
+    }
+
+    if (!rtcValid) {
+        rtcSnapshot.magic = 0;
+        if (storedRoot != 0) {
+            // El ROOT conocido permite calibrar en cuanto aparezca en la malla
+            rootNodeId = storedRoot;
+            LOG_I("[Sync] ROOT %u recuperado de NVS (sin hora válida)", storedRoot);
+        }
+        return false;
+    }
+
+    double gapMs = (nowUs - rtcSnapshot.rtcUs) / 1000.0;
+    double networkNow = rtcSnapshot.networkMs + gapMs * (1.0 + rtcSnapshot.driftPpm * 1e-6);
+
+    rootNodeId = rtcSnapshot.rootId;
+    timeOffset = networkNow - (double)millis();
+    pathDelay = rtcSnapshot.pathDelay;
+    driftPpm = rtcSnapshot.driftPpm;
+    isSynchronized = true;
+    isCalibrated = true;
+    warmStart = true;
+
+    // Confirmar el estado restaurado con una calibración en el primer ciclo
+    beaconsSinceCalibration = calibrationEvery;
+
+    LOG_I("[Sync] Arranque en caliente: ROOT %u | hueco %.0f ms | deriva %.1f ppm",
+          rootNodeId, gapMs, driftPpm);
+    return true;
 }
@@ -2,18 +2,113 @@
 #include <Arduino.h>
 #include "credentials.hpp"
 #include "SyncManager.hpp"
+#include "Log.hpp"
+#include "RelayAggregator.hpp"
+#include "FailureDetector.hpp"
+#include "FireDetector.hpp"
+#include "MemoryMonitor.hpp"
+#include "RemoteConfig.hpp"
+#include "Profiler.hpp"
+#include "PowerManager.hpp"
+
+// ========== CONFIGURACIÓN ==========
+#define SENSOR_INTERVAL_MS 5000
+#define SMOKE_CRITICAL     600   // Igual que el umbral crítico del dashboard
+#define CONGESTION_HOLD    2     // Desde este nivel las lecturas NORMAL se retienen
+
+// Agregación en relays: -DRELAY_AGGREGATION=1 para activarla
+#ifndef RELAY_AGGREGATION
+#define RELAY_AGGREGATION  0
+#endif
+#define AGG_WINDOW_MS      500
+
+// Detección de caída del ROOT por heartbeats
+#define PHI_THRESHOLD      8.0
+#define MAX_SILENCE_MS     2000  // Cota dura de detección
+
+#define STATUS_INTERVAL_MS 60000
+#define TICK_TOLERANCE_MS  100   // Desfase admitido respecto al tick global
+#define BACKFILL_GAP_MS    250   // Separación entre bloques de una ventana GRANT
+#define SYNC_INTERVAL_MS   10000
+#define ROOT_RESTORE_GRACE_MS 30000  // Tiempo para unirse a la malla conservando el ROOT de NVS/RTC
+#define SERIAL_LINE_MAX    64
+#define MAX_BUFFER_SIZE    120   // Retención escalonada: cubre horas de corte
+#define FIRE_PIN           27
+#define SMOKE_PIN          35
+
+// Sueño de nodo aislado (env child_isolated_sleep): -DCHILD_ISOLATED_SLEEP=1.
+// Solo hay sueño ligero sin vecinos; con malla la CPU baja a 80 MHz y el
+// loop se bloquea, pero la radio (AP+STA) sigue despierta.
+#ifndef CHILD_ISOLATED_SLEEP
+#define CHILD_ISOLATED_SLEEP 0
+#endif
+#define IDLE_MAX_MS        50    // Espera máxima con vecinos en la malla
+#define LIGHT_SLEEP_MIN_MS 200   // Sueño ligero solo sin vecinos y con margen
+#define JOIN_WINDOW_MS     10000 // Aislado: radio despierta para reencontrar la malla
+#define JOIN_RETRY_MS      60000 // ...y se reabre con esta periodicidad
+#define FIRE_WAKE_GAP_MS   1000  // Máximo una lectura forzada por fuego por segundo
+#define LOW_POWER_CPU_MHZ  80
+
+// Grupo para dirigir configuraciones remotas: -DNODE_GROUP=\"norte\"
+#ifndef NODE_GROUP
+#define NODE_GROUP ""
+#endif
 
 // ========== INSTANCIAS GLOBALES ==========
 Scheduler userScheduler;
 painlessMesh mesh;
-SyncManager syncManager(&mesh);
+SyncManager syncManager(&mesh, MAX_BUFFER_SIZE);
+RelayAggregator relayAggregator(&mesh, AGG_WINDOW_MS);
+FailureDetector failureDetector(PHI_THRESHOLD, MAX_SILENCE_MS);
+MemoryMonitor memoryMonitor;
+// Mismos detectores que el ROOT sobre las lecturas propias: con el ROOT
+// congestionado, una subida lenta de humo no se retiene en el buffer
+FireDetector localDetector;
+PowerManager powerManager(CHILD_ISOLATED_SLEEP, IDLE_MAX_MS, LIGHT_SLEEP_MIN_MS,
+                          JOIN_WINDOW_MS, JOIN_RETRY_MS, FIRE_WAKE_GAP_MS);
+
+// Valores de compilación hasta que llegue un CFG del ROOT
+NodeConfig configDefaults = {0, SENSOR_INTERVAL_MS, SYNC_INTERVAL_MS, STATUS_INTERVAL_MS,
+                             MAX_BUFFER_SIZE, SMOKE_CRITICAL};
+RemoteConfig remoteConfig(configDefaults, NODE_GROUP);
+
+// Estado del detector de fallos del ROOT
+bool rootSuspected = false;
+long lastHeartbeatSeq = -1;
+uint32_t suspicions = 0;
+uint32_t falseSuspicions = 0;
+
+// Lectura del tick actual a la espera de su slot de transmisión
+DataPacket pendingReading;
+bool hasPendingReading = false;
+
+// Tiempo desde el arranque hasta la primera lectura con hora de red válida
+unsigned long firstValidReadingMs = 0;
 
 // ========== PROTOTIPOS ==========
 void sendSyncRequest();
 void generateSensorData();
+void sendFireReading();
 void checkRootConnection();
 void sendDataToRoot(DataPacket reading, String tipo);
+void sendLiveReading(DataPacket reading);
+void sendRawToRoot(const String& msg);
+void advertiseBacklog(bool windowEnd);
+void sendBackfillBlock();
+void endBackfillWindow();
+void applyConfig();
+void pollSerial();
+void flushAggregation();
 bool isNodeReachable(uint32_t nodeId);
+long nextWakeDeadline();
+bool isCriticalReading(const DataPacket& reading);
+void applyCongestion();
+void alignToTick();
+void transmitPending();
+void onRootHeartbeat(long seq);
+void checkRootLiveness();
+void resetRootLiveness();
+void sendStatus();
 
 // Callbacks
 void receivedCallback(uint32_t from, String &msg);
@@ -21,9 +116,16 @@ void newConnectionCallback(uint32_t nodeId);
 void changedConnectionCallback();
 
 // ========== TAREAS ==========
-Task taskSync(10000, TASK_FOREVER, &sendSyncRequest);
-Task taskSensor(5000, TASK_FOREVER, &generateSensorData);
+Task taskSync(SYNC_INTERVAL_MS, TASK_FOREVER, &sendSyncRequest);
+Task taskSensor(SENSOR_INTERVAL_MS, TASK_FOREVER, &generateSensorData);
 Task taskCheckRoot(15000, TASK_FOREVER, &checkRootConnection);
+Task taskAggregation(50, TASK_FOREVER, &flushAggregation);
+Task taskLiveness(50, TASK_FOREVER, &checkRootLiveness);
+Task taskStatus(STATUS_INTERVAL_MS, TASK_FOREVER, &sendStatus);
+Task taskSerial(100, TASK_FOREVER, &pollSerial);
+Task taskTransmit(0, TASK_ONCE, &transmitPending);
+Task taskBackfill(BACKFILL_GAP_MS, TASK_ONCE, &sendBackfillBlock, nullptr, false,
+                  nullptr, &endBackfillWindow);
 
 // ========== SETUP ==========
 void setup() {
@@ -32,8 +134,8 @@ void setup() {
   Serial.println("CHILD NODE INICIANDO");
 
   // Configurar pines
-  pinMode(27, INPUT);
-  pinMode(35, INPUT);
+  pinMode(FIRE_PIN, INPUT);
+  pinMode(SMOKE_PIN, INPUT);
 
   // Mesh
   mesh.setDebugMsgTypes(ERROR | STARTUP | CONNECTION);
@@ -42,22 +144,87 @@ void setup() {
   mesh.onNewConnection(&newConnectionCallback);
   mesh.onChangedConnections(&changedConnectionCallback);
 
+  // Reanudar con el ROOT y la hora de red previos al reinicio
+  syncManager.restoreState();
+
+  // Telemetría de memoria: tarea del loop + tarea TCP de painlessMesh
+  memoryMonitor.registerTask("loop", xTaskGetCurrentTaskHandle());
+  memoryMonitor.registerTask("async_tcp");
+
+  // Interrupción de fuego + (con CHILD_ISOLATED_SLEEP) CPU a 80 MHz y módem en PS
+  powerManager.begin(FIRE_PIN, LOW_POWER_CPU_MHZ);
+
   // Activar tareas
   userScheduler.addTask(taskSync);
   taskSync.enable();
 
+  // Sin hora de red todavía: fase aleatoria para no arrancar en lockstep
   userScheduler.addTask(taskSensor);
-  taskSensor.enable();
+  taskSensor.enableDelayed(random(0, SENSOR_INTERVAL_MS));
 
   userScheduler.addTask(taskCheckRoot);
   taskCheckRoot.enable();
 
+  userScheduler.addTask(taskLiveness);
+  taskLiveness.enable();
+
+  userScheduler.addTask(taskStatus);
+  taskStatus.enable();
+
+  // Solo se activa cuando el ROOT concede una ventana de backfill
+  userScheduler.addTask(taskBackfill);
+
+  userScheduler.addTask(taskSerial);
+  taskSerial.enable();
+
+  // Envío diferido al slot propio tras cada tick de muestreo
+  userScheduler.addTask(taskTransmit);
+
+  // Diagnóstico: no-op salvo en el entorno child_diag
+  Profiler::begin();
+
+  if (RELAY_AGGREGATION) {
+    userScheduler.addTask(taskAggregation);
+    taskAggregation.enable();
+  }
+
+  // Última configuración aplicada: vale hasta que el ROOT difunda otra
+  if (remoteConfig.restore()) {
+    applyConfig();
+  }
+
   Serial.println("[CHILD] Esperando ROOT...\n");
 }
 
 // ========== LOOP ==========
 void loop() {
+  // Flanco de fuego: lectura inmediata fuera del tick, sin mover el periodo
+  if (powerManager.takeFireWake()) sendFireReading();
+
   mesh.update();
+
+  // Logs diferidos: solo se formatean cuando la UART tiene hueco
+  Log::drain();
+  Log::measureLoop();
+
+  // Sueño de nodo aislado: bloquear hasta el próximo evento en vez de girar
+  if (powerManager.isEnabled()) {
+    powerManager.idle(nextWakeDeadline(), mesh.getNodeList().empty());
+  }
+}
+
+// ========== HELPER: Próximo deadline de las tareas propias ==========
+// Las tareas de sondeo (liveness, agregación, serial) corren en cada despertar
+long nextWakeDeadline() {
+  Task* tasks[] = {&taskSensor, &taskSync, &taskCheckRoot, &taskStatus,
+                   &taskTransmit, &taskBackfill};
+  long next = -1;
+
+  for (Task* task : tasks) {
+    long t = userScheduler.timeUntilNextIteration(*task);
+    if (t >= 0 && (next < 0 || t < next)) next = t;
+  }
+  return next;
 }
 
 // ========== HELPER: Verificar si un nodo es alcanzable ==========
@@ -69,52 +236,232 @@ bool isNodeReachable(uint32_t nodeId) {
   return false;
 }
 
-// ========== TAREA: Solicitar sincronización NTP ==========
+// ========== TAREA: Calibración NTP ocasional ==========
+// El reloj se corrige con los beacons SYNC; el intercambio TIME solo mide la
+// latencia hacia el ROOT cada pocos beacons.
 void sendSyncRequest() {
   uint32_t root = syncManager.getRootId();
 
-  if (root != 0 && isNodeReachable(root)) {
-    StaticJsonDocument<128> doc;
-    doc["type"] = "TIME";
-    doc["src"] = mesh.getNodeId();
+  if (root != 0 && !rootSuspected && isNodeReachable(root)) {
+    if (!syncManager.needsCalibration()) return;
 
-    String msg;
-    serializeJson(doc, msg);
+    String msg = syncManager.createSyncRequest();
     mesh.sendSingle(root, msg);
 
-    Serial.printf("[SYNC] TIME request → ROOT %u\n", root);
+    LOG_I("[SYNC] TIME request → ROOT %u", root);
   } else {
-    Serial.println("[SYNC] ROOT no alcanzable, esperando broadcast...");
+    LOG_I("[SYNC] ROOT no alcanzable, esperando broadcast...");
   }
 }
 
 // ========== TAREA: Generar y enviar datos de sensores ==========
 void generateSensorData() {
   DataPacket lectura;
+  powerManager.onReading();
 
-  lectura.timestamp = syncManager.getSyncStatus() ? 
-                      syncManager.getNetworkTime() : 0;
+  // Con hora de red todos los nodos muestrean en el mismo tick global
+  lectura.timestamp = syncManager.getSyncStatus() ?
+                      syncManager.snapToTick(syncManager.getNetworkTime(),
+                                             taskSensor.getInterval(), TICK_TOLERANCE_MS) : 0;
 
-  lectura.humo  = analogRead(35);
-  lectura.fuego = digitalRead(27);
+  lectura.humo  = analogRead(SMOKE_PIN);
+  lectura.fuego = digitalRead(FIRE_PIN);
+  localDetector.update(mesh.getNodeId(), lectura.timestamp > 0 ? lectura.timestamp : millis(),
+                       lectura.humo, lectura.fuego, lectura.timestamp > 0);
 
   uint32_t root = syncManager.getRootId();
-  bool online = (root != 0 && isNodeReachable(root));
+  bool online = (root != 0 && !rootSuspected && isNodeReachable(root));
+
+  if (firstValidReadingMs == 0 && lectura.timestamp > 0) {
+    firstValidReadingMs = millis();
+    LOG_I("[BOOT] Primera lectura válida a %lu ms (arranque %s)",
+          firstValidReadingMs, syncManager.isWarmStart() ? "en caliente" : "en frío");
+    LOG_I("[BOOT] Primera lectura %s", online ? "enviada" : "en buffer");
+  }
 
   if (!online) {
-    Serial.println("[OFFLINE] Sin ROOT, guardando en buffer.");
+    LOG_I("[OFFLINE] Sin ROOT, guardando en buffer.");
+    syncManager.addToBuffer(lectura);
+    return;
+  }
+
+  // ROOT congestionado: retener lecturas normales, las críticas salen siempre
+  bool congested = syncManager.getCongestionLevel() >= CONGESTION_HOLD;
+  if (congested && !isCriticalReading(lectura)) {
     syncManager.addToBuffer(lectura);
     return;
   }
 
-  // Enviar datos
-  sendDataToRoot(lectura, "DATA");
+  // Enviar en el slot propio (las críticas salen ya); el historial pendiente
+  // espera a un GRANT del ROOT
+  unsigned long offset = syncManager.getSlotOffset(taskSensor.getInterval());
+  if (offset == 0 || isCriticalReading(lectura)) {
+    sendLiveReading(lectura);
+    return;
+  }
+
+  if (hasPendingReading) sendLiveReading(pendingReading);
+  pendingReading = lectura;
+  hasPendingReading = true;
+  taskTransmit.restartDelayed(offset);
+}
+
+// ========== FUEGO: Lectura inmediata fuera del tick ==========
+// No pasa por el slot ni por la agregación, y su ts es la hora de red sin
+// redondear: el ROOT la sube y la pasa a los detectores, pero no la mezcla
+// con el snapshot del tick.
+void sendFireReading() {
+  DataPacket lectura;
+  powerManager.onReading();
+
+  lectura.timestamp = syncManager.getSyncStatus() ? syncManager.getNetworkTime() : 0;
+  lectura.humo  = analogRead(SMOKE_PIN);
+  lectura.fuego = digitalRead(FIRE_PIN);
+
+  uint32_t root = syncManager.getRootId();
+  if (root == 0 || rootSuspected || !isNodeReachable(root)) {
+    syncManager.addToBuffer(lectura);
+    return;
+  }
+
+  powerManager.onSent();
+  sendDataToRoot(lectura, "DATA_FIRE");
+}
+
+// ========== TAREA: Transmitir la lectura del tick en su slot ==========
+void transmitPending() {
+  if (!hasPendingReading) return;
+  hasPendingReading = false;
+
+  uint32_t root = syncManager.getRootId();
+  if (root == 0 || rootSuspected || !isNodeReachable(root)) {
+    syncManager.addToBuffer(pendingReading);
+    return;
+  }
+  sendLiveReading(pendingReading);
+}
+
+// ========== HELPER: Lecturas que nunca se retienen ==========
+bool isCriticalReading(const DataPacket& reading) {
+  return reading.fuego || reading.humo >= remoteConfig.get().smokeCritical ||
+         localDetector.isAlerting(mesh.getNodeId());
+}
+
+// ========== HELPER: Estirar el muestreo según la congestión del ROOT ==========
+void applyCongestion() {
+  uint8_t level = syncManager.getCongestionLevel();
+  unsigned long interval = remoteConfig.get().sensorMs * (1 + level);
+
+  if (taskSensor.getInterval() != interval) {
+    taskSensor.setInterval(interval);
+    LOG_I("[CONG] Nivel %u → muestreo cada %lu ms", level, interval);
+  }
+}
+
+// ========== HELPER: Aplicar la configuración remota vigente ==========
+void applyConfig() {
+  const NodeConfig& cfg = remoteConfig.get();
+
+  taskSync.setInterval(cfg.syncMs);
+  taskStatus.setInterval(cfg.statusMs);
+  syncManager.setMaxBufferSize(cfg.bufferSize);
+
+  // El muestreo depende también de la congestión y del slot
+  applyCongestion();
+  alignToTick();
+}
+
+// ========== HELPER: Alinear el muestreo al tick global de hora de red ==========
+void alignToTick() {
+  if (!syncManager.getSyncStatus()) return;
+
+  unsigned long period = taskSensor.getInterval();
+  long target = syncManager.getTickDelay(period);
+  long next = userScheduler.timeUntilNextIteration(taskSensor);
+
+  // Distancia circular entre la próxima ejecución y el tick
+  long error = labs(next - target) % (long)period;
+  if (error > (long)period / 2) error = period - error;
+  if (next >= 0 && error <= TICK_TOLERANCE_MS) return;
+
+  taskSensor.restartDelayed(target);
+  LOG_D("[TICK] Muestreo realineado: próximo en %ld ms", target);
+}
+
+// ========== HEARTBEAT: Cualquier mensaje del ROOT cuenta ==========
+void onRootHeartbeat(long seq) {
+  unsigned long now = millis();
+
+  if (rootSuspected) {
+    rootSuspected = false;
+
+    // Sin heartbeats perdidos el ROOT nunca cayó: la sospecha fue falsa
+    if (seq >= 0 && lastHeartbeatSeq >= 0 && seq == lastHeartbeatSeq + 1) {
+      falseSuspicions++;
+    }
+    LOG_I("[FD] ROOT de vuelta tras %lu ms (falsos positivos %u/%u)",
+          failureDetector.silence(now), falseSuspicions, suspicions);
+
+    advertiseBacklog(false);
+  }
+
+  if (seq >= 0) lastHeartbeatSeq = seq;
+  failureDetector.heartbeat(now);
+}
+
+// ========== TAREA: Detector phi-accrual del ROOT ==========
+void checkRootLiveness() {
+  if (rootSuspected || syncManager.getRootId() == 0) return;
+
+  unsigned long now = millis();
+  if (failureDetector.isSuspected(now)) {
+    rootSuspected = true;
+    suspicions++;
+    LOG_W("[FD] ROOT sospechoso: silencio %lu ms, phi %.1f → buffering",
+          failureDetector.silence(now), failureDetector.phi(now));
+  }
+}
+
+void resetRootLiveness() {
+  failureDetector.reset();
+  rootSuspected = false;
+  lastHeartbeatSeq = -1;
+}
+
+// ========== TAREA: Estado periódico (memoria + buffer) al ROOT ==========
+void sendStatus() {
+  memoryMonitor.log();
+
+  PowerStats power = powerManager.closeWindow();
+  powerManager.log(power);
 
-  // Vaciar buffer pendiente si hay
   if (syncManager.hasBufferedData()) {
-    Serial.println("[BUFFER] Vaciando datos pendientes...");
-    syncManager.flushBuffer(sendDataToRoot);
+    LOG_I("[Buffer] %u lecturas (%u B) cubren %llu s | %u compactaciones",
+          (unsigned)syncManager.getBufferedCount(),
+          (unsigned)(syncManager.getBufferedCount() * sizeof(DataPacket)),
+          syncManager.getBufferCoverage() / 1000, syncManager.getCompactions());
   }
+
+  uint32_t root = syncManager.getRootId();
+  if (root == 0 || rootSuspected || !isNodeReachable(root)) return;
+
+  StaticJsonDocument<512> doc;
+  doc["type"] = "STATUS";
+  doc["src"] = mesh.getNodeId();
+  JsonObject body = doc.createNestedObject("body");
+  memoryMonitor.fillJson(body);
+  body["buf"] = syncManager.getBufferedCount();
+  body["cov"] = syncManager.getBufferCoverage() / 1000;
+  body["up"] = millis() / 1000;
+  body["ttfv"] = firstValidReadingMs;
+  body["warm"] = syncManager.isWarmStart();
+  body["drift"] = syncManager.getDriftPpm();
+  body["cfg"] = remoteConfig.getVersion();
+  powerManager.fillJson(body, power);
+
+  String msg;
+  serializeJson(doc, msg);
+  mesh.sendSingle(root, msg);
 }
 
 // ========== TAREA: Verificar conexión con ROOT ==========
@@ -122,19 +469,33 @@ void checkRootConnection() {
   uint32_t root = syncManager.getRootId();
 
   if (root == 0) {
-    Serial.println("[CHECK] No tengo ROOT, esperando broadcast...");
+    LOG_I("[CHECK] No tengo ROOT, esperando broadcast...");
+    return;
+  }
+
+  // Sin vecinos recién arrancado: conservar el ROOT restaurado mientras se une.
+  // Pasado el arranque, una malla vacía significa que el ROOT se perdió
+  if (mesh.getNodeList().empty() && millis() < ROOT_RESTORE_GRACE_MS) {
+    LOG_D("[CHECK] Malla sin vecinos, conservando ROOT %u", root);
     return;
   }
 
   if (!isNodeReachable(root)) {
-    Serial.printf("[CHECK] ROOT %u NO alcanzable → Reseteando...\n", root);
+    LOG_W("[CHECK] ROOT %u NO alcanzable → Reseteando...", root);
     syncManager.setRootId(0);
+    resetRootLiveness();
     syncManager.setSyncStatus(false);
-    Serial.println("[CHECK] Esperando nuevo SYNC...");
+    LOG_I("[CHECK] Esperando nuevo SYNC...");
   } else {
     auto nodes = mesh.getNodeList();
-    Serial.printf("[CHECK] ROOT %u alcanzable (%d nodos visibles)\n", 
-                  root, nodes.size());
+    LOG_D("[CHECK] ROOT %u alcanzable (%d nodos visibles)", 
+          root, nodes.size());
+
+    if (RELAY_AGGREGATION) {
+      LOG_D("[AGG] frames enviados %u | lecturas %u | frames combinados %u",
+            relayAggregator.getFramesSent(), relayAggregator.getEntriesSent(),
+            relayAggregator.getFramesMerged());
+    }
   }
 }
 
@@ -143,22 +504,96 @@ void sendDataToRoot(DataPacket reading, String tipo) {
   String jsonMsg = syncManager.createDataJSON(reading, tipo, mesh.getNodeId());
   mesh.sendSingle(syncManager.getRootId(), jsonMsg);
 
-  Serial.printf("[TX] %s ROOT | humo=%d, fuego=%d | ts=%llu\n",
-                tipo.c_str(), reading.humo, reading.fuego, reading.timestamp);
+  LOG_D("[TX] %s ROOT | humo=%d, fuego=%d | ts=%llu",
+        tipo.c_str(), reading.humo, reading.fuego, reading.timestamp);
+}
+
+// ========== BACKFILL: Historial en bloques comprimidos ==========
+void sendRawToRoot(const String& msg) {
+  mesh.sendSingle(syncManager.getRootId(), msg);
+}
+
+// Anunciar al ROOT cuánto historial queda; él decide cuándo pedirlo
+void advertiseBacklog(bool windowEnd) {
+  uint32_t root = syncManager.getRootId();
+  if (root == 0 || rootSuspected || !isNodeReachable(root)) return;
+  if (!windowEnd && !syncManager.hasBufferedData()) return;
+
+  StaticJsonDocument<128> doc;
+  doc["type"] = "BUF";
+  doc["src"] = mesh.getNodeId();
+  doc["n"] = syncManager.getBufferedCount();
+  if (windowEnd) doc["end"] = true;
+
+  String msg;
+  serializeJson(doc, msg);
+  mesh.sendSingle(root, msg);
+}
+
+// Un bloque por iteración: las lecturas en vivo se intercalan entre bloques
+void sendBackfillBlock() {
+  if (!syncManager.hasBufferedData() || rootSuspected ||
+      syncManager.getCongestionLevel() >= CONGESTION_HOLD) {
+    taskBackfill.disable();
+    return;
+  }
+  syncManager.flushBufferBlocks(sendRawToRoot, 64, 1);
+}
+
+void endBackfillWindow() {
+  LOG_D("[BACKFILL] Ventana cerrada, quedan %u lecturas",
+        (unsigned)syncManager.getBufferedCount());
+  advertiseBacklog(true);
+}
+
+// ========== ENVIAR LECTURA EN VIVO (directa o agregada) ==========
+void sendLiveReading(DataPacket reading) {
+  powerManager.onSent();
+
+  if (!RELAY_AGGREGATION) {
+    sendDataToRoot(reading, "DATA");
+    return;
+  }
+
+  // Un relay espera la ventana para combinar; una hoja reenvía al instante
+  uint32_t root = syncManager.getRootId();
+  relayAggregator.add(mesh.getNodeId(), reading, isCriticalReading(reading));
+  if (!relayAggregator.hasDownstream(root)) {
+    relayAggregator.flush(root);
+  }
+}
+
+// ========== TAREA: Cerrar ventana de agregación ==========
+void flushAggregation() {
+  uint32_t root = syncManager.getRootId();
+  if (root != 0 && relayAggregator.isDue()) {
+    relayAggregator.flush(root);
+  }
 }
 
 // ========== CALLBACK: Mensajes recibidos ==========
 void receivedCallback(uint32_t from, String &msg) {
-  StaticJsonDocument<300> doc;
+  // El beacon SYNC lleva la tabla de slots: con un documento fijo de 2 KB
+  // no entraban más de ~120 nodos
+  DynamicJsonDocument doc(SyncManager::docCapacityFor(msg));
+  if (doc.capacity() == 0) {
+    LOG_E("[RX] Sin memoria para parsear %u bytes", (unsigned)msg.length());
+    return;
+  }
   if (deserializeJson(doc, msg)) {
-    Serial.println("[RX] Error parseando JSON");
+    LOG_E("[RX] Error parseando JSON");
     return;
   }
 
-  String type = doc["type"];
+  const char* type = doc["type"] | "";
+
+  if (from == syncManager.getRootId()) {
+    onRootHeartbeat(doc["seq"] | -1L);
+  }
+  if (strcmp(type, "HB") == 0) return;
 
-  // ROOT discovery via SYNC broadcast
-  if (type == "SYNC") {
+  // ROOT discovery + beacon de tiempo via SYNC broadcast
+  if (strcmp(type, "SYNC") == 0) {
     uint32_t root = doc["root"];
     uint32_t currentRoot = syncManager.getRootId();
 
@@ -168,57 +603,108 @@ void receivedCallback(uint32_t from, String &msg) {
                        (!isNodeReachable(currentRoot));
 
     if (shouldUpdate) {
+      if (root != currentRoot) resetRootLiveness();
       syncManager.setRootId(root);
-      Serial.printf("[SYNC] ROOT actualizado: %u (desde nodo %u)\n", root, from);
-
-      // Solicitar TIME inmediatamente
-      StaticJsonDocument<128> req;
-      req["type"] = "TIME";
-      req["src"] = mesh.getNodeId();
+      LOG_I("[SYNC] ROOT actualizado: %u (desde nodo %u)", root, from);
 
-      String out;
-      serializeJson(req, out);
+      // Solicitar TIME inmediatamente para medir la latencia del nuevo ROOT
+      String out = syncManager.createSyncRequest();
       mesh.sendSingle(root, out);
+    }
+
+    syncManager.handleSyncBeacon(doc);
+    applyCongestion();
+    alignToTick();
+    LOG_D("[SYNC] Beacon | error: %.2f ms",
+          syncManager.getLastBeaconError());
+
+    // Historial pendiente: anunciarlo y esperar turno (sin ráfagas simultáneas)
+    if (!taskBackfill.isEnabled()) advertiseBacklog(false);
+    return;
+  }
 
-      // Vaciar buffer si hay datos pendientes
-      if (syncManager.hasBufferedData()) {
-        Serial.println("[SYNC] ROOT recuperado, vaciando buffer...");
-        delay(1000);  // Esperar estabilización de ruta
-        syncManager.flushBuffer(sendDataToRoot);
-      }
+  // Configuración remota versionada (difundida por el ROOT)
+  if (strcmp(type, "CFG") == 0) {
+    if (remoteConfig.apply(doc, mesh.getNodeId())) {
+      applyConfig();
     }
     return;
   }
 
+  // Ventana de backfill concedida por el ROOT: n bloques espaciados
+  if (strcmp(type, "GRANT") == 0) {
+    int blocks = doc["n"] | 1;
+    LOG_I("[BACKFILL] GRANT de %d bloques (%u lecturas en buffer)",
+          blocks, (unsigned)syncManager.getBufferedCount());
+    taskBackfill.setIterations(blocks);
+    taskBackfill.enable();
+    return;
+  }
+
   // Respuesta TIME del ROOT
-  if (type == "TIME") {
+  if (strcmp(type, "TIME") == 0) {
     syncManager.handleSyncResponse(doc);
     return;
   }
+
+  // Lecturas de nodos aguas abajo: los AGG van dirigidos al siguiente salto,
+  // así que todo relay los reenvía aunque él mismo no agregue
+  if (strcmp(type, "AGG") == 0) {
+    relayAggregator.merge(doc);
+    if (!RELAY_AGGREGATION) {
+      relayAggregator.flush(syncManager.getRootId());
+    }
+    return;
+  }
+}
+
+// ========== TAREA: Comandos por Serial ("prof", "prof reset") ==========
+void pollSerial() {
+  static char line[SERIAL_LINE_MAX];
+  static size_t len = 0;
+
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+
+    if (c != '\n') {
+      if (len < sizeof(line) - 1) line[len++] = c;
+      continue;
+    }
+
+    line[len] = '\0';
+    len = 0;
+
+    if (!Profiler::handleCommand(line) && line[0] != '\0') {
+      LOG_W("[SERIAL] Comando desconocido: %s", line);
+    }
+  }
 }
 
 // ========== CALLBACK: Nueva conexión ==========
 void newConnectionCallback(uint32_t nodeId) {
-  Serial.printf("[MESH] Nueva conexión: %u\n", nodeId);
+  LOG_I("[MESH] Nueva conexión: %u", nodeId);
 
-  // Si ROOT vuelve a estar alcanzable, vaciar buffer
-  uint32_t root = syncManager.getRootId();
-  if (root != 0 && isNodeReachable(root) && syncManager.hasBufferedData()) {
-    Serial.println("[MESH] ROOT alcanzable, vaciando buffer...");
-    delay(500);
-    syncManager.flushBuffer(sendDataToRoot);
-  }
+  // Si ROOT vuelve a estar alcanzable, anunciar el historial pendiente
+  advertiseBacklog(false);
 }
 
 // ========== CALLBACK: Topología cambió ==========
 void changedConnectionCallback() {
   auto nodes = mesh.getNodeList();
-  Serial.printf("[MESH] Topología cambió (%d nodos visibles)\n", nodes.size());
+  LOG_I("[MESH] Topología cambió (%d nodos visibles)", nodes.size());
 
   uint32_t root = syncManager.getRootId();
-  if (root != 0 && !isNodeReachable(root)) {
-    Serial.printf("[MESH] ROOT %u perdido en cambio de topología\n", root);
+  if (root == 0) return;
+  if (nodes.empty() && millis() < ROOT_RESTORE_GRACE_MS) return;
+
+  if (!isNodeReachable(root)) {
+    LOG_W("[MESH] ROOT %u perdido en cambio de topología", root);
     syncManager.setRootId(0);
+    resetRootLiveness();
     syncManager.setSyncStatus(false);
+  } else if (syncManager.needsCalibration()) {
+    // ROOT conocido (NVS o RTC) alcanzable: calibrar sin esperar al beacon
+    sendSyncRequest();
   }
 }
\ No newline at end of file
@@ -5,6 +5,40 @@
 #include "WiFiManager.hpp"
 #include "FirebaseManager.hpp"
 #include "SyncManager.hpp"
+#include "FireDetector.hpp"
+#include "Log.hpp"
+#include "MemoryMonitor.hpp"
+#include "PresenceManager.hpp"
+#include "BackfillScheduler.hpp"
+#include "RemoteConfig.hpp"
+#include "Profiler.hpp"
+#include "SnapshotAssembler.hpp"
+#include "RelayAggregator.hpp"
+
+// ========== CONFIGURACIÓN ==========
+#define HEARTBEAT_MS 500  // Los childs detectan la caída en < 1 s
+#define STATUS_INTERVAL_MS 60000
+#define PRESENCE_CHECK_MS 5000     // Reconciliación periódica con la topología
+#define PRESENCE_MIN_GAP_MS 1000   // Como mucho una subida de presencia por segundo
+
+// Backfill coordinado: ventanas GRANT de pocos bloques, un child a la vez
+#define BACKFILL_CONCURRENCY 1
+#define BACKFILL_BLOCKS      4
+#define BACKFILL_TICK_MS     500
+
+// Configuración remota: ruta en Firebase y reenvío para nodos que se unen tarde
+#define CONFIG_PATH          "config"
+#define CONFIG_POLL_MS       1000
+#define CONFIG_REBROADCAST_MS 60000
+#define SERIAL_LINE_MAX      384
+
+// Congestión anunciada a la malla: las subidas se avisan en el acto (como mucho
+// una por CONGESTION_MIN_GAP_MS) y las bajadas tras CONGESTION_HOLD_MS estables
+#define CONGESTION_MIN_GAP_MS 1000
+#define CONGESTION_HOLD_MS    3000
+
+// Snapshots de flota: plazo desde el tick (cubre el periodo de muestreo + red)
+#define SNAPSHOT_DEADLINE_MS 6000
 
 // ========== INSTANCIAS GLOBALES ==========
 Scheduler userScheduler;
@@ -12,15 +46,64 @@ painlessMesh mesh;
 WiFiManager wifiManager(WIFI_SSID, WIFI_PASSWORD);
 FirebaseManager firebaseManager;
 SyncManager syncManager(&mesh);
+FireDetector fireDetector;
+MemoryMonitor memoryMonitor;
+PresenceManager presenceManager(&mesh);
+BackfillScheduler backfillScheduler(BACKFILL_CONCURRENCY, BACKFILL_BLOCKS);
+
+// El ROOT solo guarda la versión y el historial de CFG; los valores los aplican los childs
+NodeConfig configDefaults = {0, 5000, 10000, 60000, 20, 600};
+RemoteConfig remoteConfig(configDefaults);
+SnapshotAssembler snapshotAssembler(SNAPSHOT_DEADLINE_MS);
+
+// Nivel que conocen los childs (con histéresis sobre el de la cola)
+uint8_t meshCongestion = 0;
 
 // ========== PROTOTIPOS ==========
 void receivedCallback(uint32_t from, String &msg);
 void newConnectionCallback(uint32_t nodeId);
 void changedConnectionCallback();
 void announceRoot();
+void sendHeartbeat();
+void publishStatus();
+void reportSyncStats();
+void fireEventCallback(const FireEvent& evt);
+void processUploads();
+void checkPresence();
+void grantBackfill();
+void checkConfig();
+void rebroadcastConfig();
+void pollSerial();
+void handleConfig(const String& json);
+void snapshotCallback(const FleetSnapshot& snapshot);
+void nodeOfflineCallback(uint32_t nodeId);
+void handleReading(uint32_t srcNode, const char* type, unsigned long long ts, int humo, int fuego);
+bool isCriticalReading(const char* type, int humo, int fuego);
+
+// Tráfico mesh recibido (frames vs lecturas) desde el último reporte
+uint32_t meshFrames = 0;
+uint32_t meshReadings = 0;
+
+// Pico de ingesta en ventanas de 1 s (relación pico/media de la ráfaga)
+uint32_t readingsThisSecond = 0;
+uint32_t peakReadingsPerSecond = 0;
+unsigned long secondStart = 0;
+
+// Latencia de datos en vivo (ms), separada según haya backfill en curso
+uint64_t liveLatencySum[2] = {0, 0};
+uint32_t liveLatencyCount[2] = {0, 0};
 
 // ========== TAREAS ==========
 Task taskAnnounceRoot(10000, TASK_FOREVER, &announceRoot);
+Task taskHeartbeat(HEARTBEAT_MS, TASK_FOREVER, &sendHeartbeat);
+Task taskStatus(STATUS_INTERVAL_MS, TASK_FOREVER, &publishStatus);
+Task taskUpload(50, TASK_FOREVER, &processUploads);
+Task taskSyncStats(60000, TASK_FOREVER, &reportSyncStats);
+Task taskPresence(PRESENCE_CHECK_MS, TASK_FOREVER, &checkPresence);
+Task taskBackfill(BACKFILL_TICK_MS, TASK_FOREVER, &grantBackfill);
+Task taskConfig(CONFIG_POLL_MS, TASK_FOREVER, &checkConfig);
+Task taskConfigRebroadcast(CONFIG_REBROADCAST_MS, TASK_FOREVER, &rebroadcastConfig);
+Task taskSerial(100, TASK_FOREVER, &pollSerial);
 
 // ========== SETUP ==========
 void setup() {
@@ -36,6 +119,7 @@ void setup() {
       FIREBASE_USER_EMAIL,
       FIREBASE_USER_PASSWORD
     );
+    firebaseManager.beginConfigStream(CONFIG_PATH);
   } else {
     Serial.println("[ERROR] Sin WiFi. Firebase deshabilitado.");
   }
@@ -49,84 +133,436 @@ void setup() {
   mesh.stationManual(WIFI_SSID, WIFI_PASSWORD);
   mesh.setHostname("FireMesh_Root");
 
-  // 3. Activar broadcast periódico
+  // Telemetría de memoria: tarea del loop + tarea TCP de painlessMesh
+  memoryMonitor.registerTask("loop", xTaskGetCurrentTaskHandle());
+  memoryMonitor.registerTask("async_tcp");
+
+  // 3. Detectores de incendio por nodo + snapshots por tick
+  fireDetector.onEvent(&fireEventCallback);
+  presenceManager.onOffline(&nodeOfflineCallback);
+  snapshotAssembler.onSnapshot(&snapshotCallback);
+
+  // 4. Activar broadcast periódico
   userScheduler.addTask(taskAnnounceRoot);
   taskAnnounceRoot.enable();
 
+  userScheduler.addTask(taskHeartbeat);
+  taskHeartbeat.enable();
+
+  userScheduler.addTask(taskStatus);
+  taskStatus.enable();
+
+  userScheduler.addTask(taskSyncStats);
+  taskSyncStats.enable();
+
+  userScheduler.addTask(taskPresence);
+  taskPresence.enable();
+
+  userScheduler.addTask(taskBackfill);
+  taskBackfill.enable();
+
+  // 6. Plano de control: Firebase + sustituto local por Serial ("cfg {...}")
+  userScheduler.addTask(taskConfig);
+  taskConfig.enable();
+
+  userScheduler.addTask(taskConfigRebroadcast);
+  taskConfigRebroadcast.enable();
+
+  userScheduler.addTask(taskSerial);
+  taskSerial.enable();
+
+  // 5. Subida a Firebase desacoplada de la recepción
+  userScheduler.addTask(taskUpload);
+  taskUpload.enable();
+
+  // Diagnóstico: no-op salvo en el entorno root_diag
+  Profiler::begin();
+
   Serial.println("[ROOT] Sistema iniciado - Broadcast activo cada 10s\n");
 }
 
 // ========== LOOP ==========
 void loop() {
   mesh.update();
+
+  // Logs diferidos: solo se formatean cuando la UART tiene hueco
+  Log::drain();
+  Log::measureLoop();
 }
 
-// ========== BROADCAST: Anunciar ROOT cada 10s ==========
+// ========== BROADCAST: Anunciar ROOT + beacon de tiempo cada 10s ==========
 void announceRoot() {
-  StaticJsonDocument<128> doc;
-  doc["type"] = "SYNC";
-  doc["root"] = mesh.getNodeId();
+  String msg = syncManager.createSyncBeacon(meshCongestion);
+  mesh.sendBroadcast(msg);
+
+  auto nodes = mesh.getNodeList();
+  LOG_I("[ROOT] Broadcast SYNC (ID: %u | %d childs visibles)", 
+        mesh.getNodeId(), nodes.size());
+}
+
+// ========== BROADCAST: Heartbeat ligero para el detector de fallos ==========
+void sendHeartbeat() {
+  static uint32_t seq = 0;
+
+  StaticJsonDocument<64> doc;
+  doc["type"] = "HB";
+  doc["seq"] = seq++;
 
   String msg;
   serializeJson(doc, msg);
   mesh.sendBroadcast(msg);
+}
+
+// ========== TAREA: Publicar estado propio (memoria + ingesta) ==========
+void publishStatus() {
+  memoryMonitor.log();
 
+  StaticJsonDocument<384> doc;
+  JsonObject body = doc.to<JsonObject>();
+  memoryMonitor.fillJson(body);
+  body["backlog"] = firebaseManager.getBacklog();
+  body["up"] = millis() / 1000;
+
+  String json;
+  serializeJson(doc, json);
+  firebaseManager.enqueueStatus(mesh.getNodeId(), json);
+}
+
+// ========== ESTADÍSTICAS: Mensajes de sincronización por minuto ==========
+void reportSyncStats() {
   auto nodes = mesh.getNodeList();
-  Serial.printf("[ROOT] Broadcast SYNC (ID: %u | %d childs visibles)\n", 
-                mesh.getNodeId(), nodes.size());
+  LOG_I("[ROOT] Sync: %u mensajes/min (%d nodos)",
+        syncManager.takeSyncMessageCount(), nodes.size());
+  LOG_I("[ROOT] Mesh: %.2f frames/s | %.2f lecturas/s",
+        meshFrames / 60.0, meshReadings / 60.0);
+  LOG_I("[ROOT] Ingesta pico %u lecturas/s (pico/media %.1f)",
+        peakReadingsPerSecond, meshReadings > 0 ? peakReadingsPerSecond * 60.0 / meshReadings : 0.0);
+  meshFrames = 0;
+  meshReadings = 0;
+  peakReadingsPerSecond = 0;
+  LOG_I("[ROOT] Ingesta: backlog %u | descartadas %u",
+        (unsigned)firebaseManager.getBacklog(), firebaseManager.getDroppedUploads());
+
+  // Coste del backfill sobre el tráfico en vivo
+  LOG_I("[ROOT] Latencia en vivo: %.0f ms normal | %.0f ms con backfill",
+        liveLatencyCount[0] ? (double)liveLatencySum[0] / liveLatencyCount[0] : 0.0,
+        liveLatencyCount[1] ? (double)liveLatencySum[1] / liveLatencyCount[1] : 0.0);
+  LOG_I("[ROOT] Detectores: %u nodos con estado", (unsigned)fireDetector.trackedNodes());
+  LOG_I("[ROOT] Snapshots: %u completos | %u por plazo | %u lecturas tardías",
+        snapshotAssembler.getClosedComplete(), snapshotAssembler.getClosedDeadline(),
+        snapshotAssembler.getLateEntries());
+  LOG_I("[ROOT] Backfill: %u en cola | %u ventanas | %u recuperados (último %lu ms)",
+        (unsigned)backfillScheduler.waitingCount(), backfillScheduler.getGrantsIssued(),
+        backfillScheduler.getRecoveriesCompleted(), backfillScheduler.getLastRecoveryMs());
+  for (int i = 0; i < 2; i++) {
+    liveLatencySum[i] = 0;
+    liveLatencyCount[i] = 0;
+  }
+}
+
+// ========== TAREA: Conceder ventanas de backfill ==========
+// Solo con la subida a Firebase descargada: lo vivo y lo crítico van primero.
+void grantBackfill() {
+  if (firebaseManager.getCongestionLevel() > 0) return;
+
+  uint32_t nodeId;
+  if (!backfillScheduler.nextGrant(nodeId, millis())) return;
+
+  StaticJsonDocument<64> doc;
+  doc["type"] = "GRANT";
+  doc["n"] = backfillScheduler.getBlocksPerGrant();
+
+  String msg;
+  serializeJson(doc, msg);
+  mesh.sendSingle(nodeId, msg);
+  LOG_D("[BACKFILL] GRANT → nodo %u", nodeId);
+}
+
+// ========== TAREA: Vaciar cola de subida y propagar congestión ==========
+void processUploads() {
+  static unsigned long lastPresenceUpload = 0;
+  static unsigned long lastCongestionAnnounce = 0;
+  static unsigned long congestionLowSince = 0;
+
+  // La hora de red es el millis() del ROOT
+  snapshotAssembler.poll(millis());
+
+  // Un solo PATCH pequeño con los cambios de presencia, en lugar de una lectura
+  if (presenceManager.hasChanges() && millis() - lastPresenceUpload >= PRESENCE_MIN_GAP_MS) {
+    lastPresenceUpload = millis();
+
+    FirebaseJson delta;
+    if (presenceManager.buildDelta(delta) && firebaseManager.updatePresence(delta)) {
+      presenceManager.clearChanges();
+    }
+  } else {
+    firebaseManager.processQueue(1);
+  }
+
+  // Avisar a la malla sin esperar al próximo beacon, con histéresis: un backlog
+  // oscilando en un umbral no debe disparar un SYNC cada 50 ms
+  unsigned long now = millis();
+  uint8_t congestion = firebaseManager.getCongestionLevel();
+  if (congestion >= meshCongestion) congestionLowSince = now;
+
+  bool rise = congestion > meshCongestion && now - lastCongestionAnnounce >= CONGESTION_MIN_GAP_MS;
+  bool fall = congestion < meshCongestion && now - congestionLowSince >= CONGESTION_HOLD_MS;
+  if (rise || fall) {
+    LOG_I("[ROOT] Congestión %u -> %u (backlog %u)",
+          meshCongestion, congestion, (unsigned)firebaseManager.getBacklog());
+    meshCongestion = congestion;
+    lastCongestionAnnounce = now;
+    congestionLowSince = now;
+    announceRoot();
+  }
+}
+
+// ========== TAREA: Reconciliar presencia con la malla ==========
+void checkPresence() {
+  presenceManager.updateTopology();
+}
+
+// ========== TAREA: Configuración remota desde Firebase ==========
+void checkConfig() {
+  // Si Firebase no estaba listo en setup, reintentar el stream en cada sondeo
+  if (!firebaseManager.isStreaming()) {
+    if (!firebaseManager.beginConfigStream(CONFIG_PATH)) return;
+  }
+
+  String json;
+  if (firebaseManager.pollConfig(json)) {
+    handleConfig(json);
+  }
+}
+
+void handleConfig(const String& json) {
+  String msg;
+  if (!remoteConfig.load(json, msg)) return;
+
+  mesh.sendBroadcast(msg);
+  LOG_I("[CFG] Versión %u difundida a la malla", remoteConfig.getVersion());
+}
+
+// Los nodos que se unen después reproducen el historial en el siguiente reenvío
+void rebroadcastConfig() {
+  for (size_t i = 0; i < remoteConfig.messageCount(); i++) {
+    mesh.sendBroadcast(remoteConfig.getMessage(i));
+  }
+}
+
+// ========== TAREA: Comandos por Serial ==========
+// "cfg {json}" sustituye a Firebase para probar el plano de control en local;
+// "prof" / "prof reset" manejan el profiler de los builds de diagnóstico.
+void pollSerial() {
+  static char line[SERIAL_LINE_MAX];
+  static size_t len = 0;
+
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+
+    if (c != '\n') {
+      if (len < sizeof(line) - 1) line[len++] = c;
+      continue;
+    }
+
+    line[len] = '\0';
+    len = 0;
+
+    if (strncmp(line, "cfg ", 4) == 0) {
+      handleConfig(String(line + 4));
+    } else if (Profiler::handleCommand(line)) {
+      // Volcado o reinicio del histograma
+    } else if (line[0] != '\0') {
+      LOG_W("[SERIAL] Comando desconocido: %s", line);
+    }
+  }
 }
 
 // ========== CALLBACK: Mensajes recibidos ==========
 void receivedCallback(uint32_t from, String &msg) {
-  StaticJsonDocument<300> doc;
+  presenceManager.markSeen(from);
+
+  // El frame más grande que llega es un AGG completo (AGG_MAX_ENTRIES lecturas)
+  StaticJsonDocument<AGG_DOC_SIZE> doc;
   if (deserializeJson(doc, msg)) {
-    Serial.println("[ROOT] Error parseando JSON");
+    LOG_E("[ROOT] Error parseando JSON");
     return;
   }
 
-  String type = doc["type"];
+  const char* type = doc["type"] | "";
 
   // Respuesta a solicitud de sincronización NTP
-  if (type == "TIME") {
-    syncManager.handleSyncRequest(from);
+  if (strcmp(type, "TIME") == 0) {
+    syncManager.handleSyncRequest(from, doc);
+    return;
+  }
+
+  // Bloque comprimido de historial: se sube como un solo registro
+  if (strcmp(type, "DATA_BLK") == 0) {
+    JsonObject body = doc["body"];
+    if (body.isNull()) {
+      LOG_W("[ROOT] Body ausente en DATA_BLK");
+      return;
+    }
+
+    meshFrames++;
+    meshReadings += body["n"].as<uint32_t>();
+    firebaseManager.enqueueBlock(doc["src"], body["t0"], body["t1"], body["n"], body["blk"]);
     return;
   }
 
   // Recepción de datos de sensores
-  if (type.startsWith("DATA")) {
+  if (strncmp(type, "DATA", 4) == 0) {
     if (doc["body"].isNull()) {
-      Serial.println("[ROOT] Body ausente en DATA");
+      LOG_W("[ROOT] Body ausente en DATA");
+      return;
+    }
+
+    meshFrames++;
+    handleReading(doc["src"], type, doc["body"]["ts"], doc["body"]["humo"], doc["body"]["fuego"]);
+    return;
+  }
+
+  // Anuncio de historial pendiente; "end" cierra la ventana concedida
+  if (strcmp(type, "BUF") == 0) {
+    backfillScheduler.onAdvertise(doc["src"], doc["n"] | 0, doc["end"] | false, millis());
+    return;
+  }
+
+  // Estado periódico de un child: se sube tal cual
+  if (strcmp(type, "STATUS") == 0) {
+    String json;
+    serializeJson(doc["body"], json);
+    firebaseManager.enqueueStatus(doc["src"], json);
+    return;
+  }
+
+  // Frame combinado por un relay: [src, ts, humo, fuego] por lectura
+  if (strcmp(type, "AGG") == 0) {
+    meshFrames++;
+    for (JsonArray item : doc["items"].as<JsonArray>()) {
+      handleReading(item[0], "DATA", item[1], item[2], item[3]);
+    }
+  }
+}
+
+// ========== PROCESAR LECTURA INDIVIDUAL ==========
+void handleReading(uint32_t srcNode, const char* type, unsigned long long ts, int humo, int fuego) {
+  meshReadings++;
+  presenceManager.markSeen(srcNode);
+
+  unsigned long now = millis();
+  if (now - secondStart >= 1000) {
+    secondStart = now;
+    readingsThisSecond = 0;
+  }
+  if (++readingsThisSecond > peakReadingsPerSecond) {
+    peakReadingsPerSecond = readingsThisSecond;
+  }
+
+  LOG_D("[ROOT] DATA de nodo %u | humo=%d, fuego=%d, ts=%llu",
+        srcNode, humo, fuego, ts);
+
+  // Detectores en streaming solo sobre datos en vivo (DATA_HIST llega desordenado).
+  // DATA_FIRE es la lectura forzada por el flanco de fuego, fuera del tick.
+  bool onTick = strcmp(type, "DATA") == 0;
+  if (onTick || strcmp(type, "DATA_FIRE") == 0) {
+    // La hora de red es el millis() del ROOT
+    if (ts > 0 && ts <= millis()) {
+      int idx = backfillScheduler.isRecovering() ? 1 : 0;
+      liveLatencySum[idx] += millis() - ts;
+      liveLatencyCount[idx]++;
+    }
+    // Sin hora de red la serie usa la llegada al ROOT; el detector no mezcla ambas
+    fireDetector.update(srcNode, ts > 0 ? ts : (unsigned long long)millis(), humo, fuego, ts > 0);
+
+    // Con hora de red: un registro por tick para toda la flota, sin copia en
+    // nodos/<id> (el dashboard lee snapshots)
+    if (onTick && ts > 0) {
+      snapshotAssembler.add(srcNode, ts, humo, fuego);
       return;
     }
+  }
+
+  // Por nodo: lecturas sin hora de red, DATA_FIRE (fuera del tick) y DATA_HIST
+  firebaseManager.enqueueData(humo, fuego, ts, type, srcNode, isCriticalReading(type, humo, fuego));
+}
+
+// ========== HELPER: Lecturas que la cola llena nunca descarta ==========
+bool isCriticalReading(const char* type, int humo, int fuego) {
+  return fuego || humo >= remoteConfig.get().smokeCritical || strcmp(type, "DATA_FIRE") == 0;
+}
 
-    int humo = doc["body"]["humo"];
-    int fuego = doc["body"]["fuego"];
-    unsigned long long ts = doc["body"]["ts"];
-    uint32_t srcNode = doc["src"];
+// ========== CALLBACK: Snapshot de flota cerrado ==========
+void snapshotCallback(const FleetSnapshot& snapshot) {
+  DynamicJsonDocument doc(128 + 64 * snapshot.entries.size());
 
-    Serial.printf("[ROOT] DATA de nodo %u | humo=%d, fuego=%d, ts=%llu\n",
-                  srcNode, humo, fuego, ts);
+  // Tardío: solo las lecturas nuevas, se fusionan bajo snapshots/{pushKey}/nodes
+  JsonObject nodes;
+  if (snapshot.late) {
+    nodes = doc.to<JsonObject>();
+  } else {
+    doc["ts"] = snapshot.ts;
+    doc["n"] = snapshot.entries.size();
+    doc["exp"] = snapshot.expected;
+    nodes = doc.createNestedObject("nodes");
+  }
 
-    firebaseManager.sendData(humo, fuego, ts, type, srcNode);
+  bool critical = false;
+  for (const SnapshotEntry& entry : snapshot.entries) {
+    critical = critical || isCriticalReading("DATA", entry.humo, entry.fuego);
+    JsonObject node = nodes.createNestedObject(String(entry.nodeId));
+    node["humo"] = entry.humo;
+    node["fuego"] = entry.fuego;
   }
+
+  String json;
+  serializeJson(doc, json);
+  firebaseManager.enqueueSnapshot(snapshot.ts, snapshot.late, json, critical);
+}
+
+// ========== CALLBACK: Evento derivado de los detectores ==========
+void fireEventCallback(const FireEvent& evt) {
+  const char* name = FireDetector::eventName(evt.type);
+  LOG_I("[ALERTA] %s nodo %u | humo=%d, pendiente=%.1f/s",
+        name, evt.nodeId, evt.humo, evt.slope);
+
+  // Se emite desde el receive de la malla: a la cola, nunca un pushJSON aquí
+  firebaseManager.enqueueAlert(name, evt.humo, evt.slope, evt.cusum, evt.ts, evt.nodeId);
+}
+
+// ========== CALLBACK: Nodo fuera de la malla ==========
+void nodeOfflineCallback(uint32_t nodeId) {
+  fireDetector.forget(nodeId);
+
+  // Sin esto isRecovering() sigue activo y el turno se bloquea 10 s por ventana;
+  // si vuelve, el child anuncia su historial de nuevo al reconectar
+  backfillScheduler.forget(nodeId);
 }
 
 // ========== CALLBACK: Nueva conexión directa ==========
 void newConnectionCallback(uint32_t nodeId) {
-  Serial.printf("[ROOT] Nueva conexión directa: %u\n", nodeId);
+  LOG_I("[ROOT] Nueva conexión directa: %u", nodeId);
+  syncManager.updateSlots(mesh.getNodeList());
+  presenceManager.updateTopology();
 
   // Enviar SYNC inmediato al nuevo nodo
-  StaticJsonDocument<128> doc;
-  doc["type"] = "SYNC";
-  doc["root"] = mesh.getNodeId();
-
-  String msg;
-  serializeJson(doc, msg);
+  String msg = syncManager.createSyncBeacon(meshCongestion);
   mesh.sendSingle(nodeId, msg);
+
+  // Y el historial de configuración, en orden de versión
+  for (size_t i = 0; i < remoteConfig.messageCount(); i++) {
+    mesh.sendSingle(nodeId, remoteConfig.getMessage(i));
+  }
 }
 
 //CALLBACK
 void changedConnectionCallback() {
   auto nodes = mesh.getNodeList();
-  Serial.printf("[ROOT] Topología cambió (%d nodos ahora)\n", nodes.size());
+  LOG_I("[ROOT] Topología cambió (%d nodos ahora)", nodes.size());
+
+  // Los slots viajan en el próximo beacon SYNC
+  syncManager.updateSlots(nodes);
+  presenceManager.updateTopology();
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+import { getFanoutHub, FanoutConnection } from '@/lib/fanout';
+
+// Conexión SSE de larga duración: siempre dinámica y en el runtime de Node
+export const runtime = 'nodejs';
+export const dynamic = 'force-dynamic';
+
+// Cola máxima por cliente antes de considerarlo lento (un snapshot completo cabe)
+const STREAM_HIGH_WATER_BYTES = 256 * 1024;
+
+/**
+ * GET /api/stream - Estado de todos los dispositivos por Server-Sent Events
+ */
+export async function GET(request: Request) {
+  const encoder = new TextEncoder();
+  let connection: FanoutConnection | null = null;
+
+  const close = (controller: ReadableStreamDefaultController<Uint8Array>) => {
+    connection?.disconnect();
+    connection = null;
+    try {
+      controller.close();
+    } catch {
+      // Ya cerrado
+    }
+  };
+
+  const stream = new ReadableStream<Uint8Array>(
+    {
+      start(controller) {
+        connection = getFanoutHub().connect(
+          (chunk) => {
+            // Cola llena: el hub deja de enviarle deltas hasta el próximo pull()
+            if ((controller.desiredSize ?? 0) <= 0) return false;
+            try {
+              controller.enqueue(encoder.encode(chunk));
+              return true;
+            } catch {
+              // Stream ya cerrado: la baja llega por el abort
+              return false;
+            }
+          },
+          () => close(controller)
+        );
+
+        request.signal.addEventListener('abort', () => close(controller));
+      },
+      pull() {
+        // El cliente leyó: si se saltó deltas, recibe el estado completo
+        connection?.resync();
+      },
+      cancel() {
+        connection?.disconnect();
+        connection = null;
+      },
+    },
+    { highWaterMark: STREAM_HIGH_WATER_BYTES, size: (chunk) => chunk.byteLength }
+  );
+
+  return new Response(stream, {
+    headers: {
+      'Content-Type': 'text/event-stream; charset=utf-8',
+      'Cache-Control': 'no-cache, no-transform',
+      Connection: 'keep-alive',
+      'X-Accel-Buffering': 'no',
+    },
+  });
+}
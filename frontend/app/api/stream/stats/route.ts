@@ -0,0 +1,11 @@
+import { getFanoutHub } from '@/lib/fanout';
+
+export const runtime = 'nodejs';
+export const dynamic = 'force-dynamic';
+
+/**
+ * GET /api/stream/stats - Clientes, deltas y memoria del hub de difusión
+ */
+export async function GET() {
+  return Response.json(getFanoutHub().getStats());
+}
@@ -6,7 +6,7 @@ import { Card, CardContent, CardDescription, CardHeader, CardTitle } from '@/com
 import { Alert, AlertDescription, AlertTitle } from '@/components/ui/alert';
 import DeviceList from '@/components/DeviceList';
 import { DeviceMapMarker } from '@/lib/types';
-import { subscribeToAllDevices, getAllDeviceInfo } from '@/lib/realtime';
+import { subscribeToAllDevicesStream, getAllDeviceInfo } from '@/lib/realtime';
 import { AlertCircle, Flame, Activity } from 'lucide-react';
 
 // Importar mapa dinámicamente para evitar SSR issues con Leaflet
@@ -51,9 +51,9 @@ export default function Dashboard() {
     loadDeviceInfo();
   }, []);
 
-  // Suscribirse a datos en tiempo real (Firebase)
+  // Suscribirse a datos en tiempo real (hub SSE compartido del servidor)
   useEffect(() => {
-    const unsubscribe = subscribeToAllDevices((data) => {
+    const unsubscribe = subscribeToAllDevicesStream((data) => {
       
       // Actualizar dispositivos con datos en tiempo real
       setDevices((prevDevices) =>
@@ -0,0 +1,236 @@
+import { RealtimeDeviceData } from './types';
+import { subscribeToAllDevices } from './realtime';
+
+/**
+ * Hub de difusión en el servidor: UNA suscripción a Firebase (snapshots + presencia)
+ * compartida por todos los dashboards abiertos. El estado por dispositivo se
+ * calcula una sola vez y a cada cliente SSE solo le llegan los campos que cambian.
+ *
+ * Eventos SSE:
+ *   snapshot: { v, sent, devices: Record<deviceId, RealtimeDeviceData> }
+ *   delta:    { v, sent, devices: Record<deviceId, Partial<RealtimeDeviceData>>, removed?: string[] }
+ *             (un campo a null en devices significa que desapareció del dispositivo)
+ *
+ * Un cliente lento (cola del stream llena) deja de recibir deltas; cuando vacía
+ * su cola recibe un snapshot nuevo, y si no lo hace en SLOW_CLIENT_DROP_MS se cierra.
+ */
+
+export type DeviceDelta = Record<string, Partial<RealtimeDeviceData>>;
+
+// send devuelve false si el cliente no admite más datos (backpressure)
+interface FanoutClient {
+  id: number;
+  send: (chunk: string) => boolean;
+  close: () => void;
+  staleSince: number | null;
+}
+
+export interface FanoutConnection {
+  disconnect: () => void;
+  // El cliente vació su cola: reenviarle el estado completo si se saltó deltas
+  resync: () => void;
+}
+
+export interface FanoutStats {
+  clients: number;
+  peakClients: number;
+  version: number;
+  upstreamUpdates: number;
+  deltasSent: number;
+  bytesSent: number;
+  lastFanoutMs: number;
+  staleClients: number;
+  resyncs: number;
+  slowDropped: number;
+  heapUsedMb: number;
+}
+
+// Tras desconectarse el último cliente, mantener el upstream un rato (recargas)
+const UPSTREAM_GRACE_MS = 30000;
+const KEEPALIVE_MS = 15000;
+const SLOW_CLIENT_DROP_MS = 60000;
+
+class FanoutHub {
+  private clients = new Map<number, FanoutClient>();
+  private state: Record<string, RealtimeDeviceData> = {};
+  private version = 0;
+  private nextClientId = 1;
+  private unsubscribe: (() => void) | null = null;
+  private idleTimer: ReturnType<typeof setTimeout> | null = null;
+  private keepAlive: ReturnType<typeof setInterval> | null = null;
+
+  private peakClients = 0;
+  private upstreamUpdates = 0;
+  private deltasSent = 0;
+  private bytesSent = 0;
+  private lastFanoutMs = 0;
+  private resyncs = 0;
+  private slowDropped = 0;
+
+  connect(send: (chunk: string) => boolean, close: () => void): FanoutConnection {
+    const client: FanoutClient = { id: this.nextClientId++, send, close, staleSince: null };
+    this.clients.set(client.id, client);
+    this.peakClients = Math.max(this.peakClients, this.clients.size);
+
+    if (this.idleTimer) {
+      clearTimeout(this.idleTimer);
+      this.idleTimer = null;
+    }
+    this.ensureUpstream();
+
+    // Estado completo al conectar; a partir de aquí solo deltas
+    this.write(client, 'snapshot', { v: this.version, sent: Date.now(), devices: this.state });
+
+    return {
+      disconnect: () => this.disconnect(client.id),
+      resync: () => this.resync(client.id),
+    };
+  }
+
+  getStats(): FanoutStats {
+    return {
+      clients: this.clients.size,
+      peakClients: this.peakClients,
+      version: this.version,
+      upstreamUpdates: this.upstreamUpdates,
+      deltasSent: this.deltasSent,
+      bytesSent: this.bytesSent,
+      lastFanoutMs: this.lastFanoutMs,
+      staleClients: Array.from(this.clients.values()).filter((c) => c.staleSince !== null).length,
+      resyncs: this.resyncs,
+      slowDropped: this.slowDropped,
+      heapUsedMb: Math.round(process.memoryUsage().heapUsed / 1048576),
+    };
+  }
+
+  private resync(id: number) {
+    const client = this.clients.get(id);
+    if (!client || client.staleSince === null) return;
+
+    client.staleSince = null;
+    this.resyncs++;
+    this.write(client, 'snapshot', { v: this.version, sent: Date.now(), devices: this.state });
+  }
+
+  private disconnect(id: number) {
+    if (!this.clients.delete(id)) return;
+    if (this.clients.size > 0 || this.idleTimer) return;
+
+    this.idleTimer = setTimeout(() => {
+      this.idleTimer = null;
+      if (this.clients.size === 0) this.stopUpstream();
+    }, UPSTREAM_GRACE_MS);
+  }
+
+  private ensureUpstream() {
+    if (this.unsubscribe) return;
+
+    console.log('[fanout] Abriendo suscripción upstream a Firebase');
+    this.unsubscribe = subscribeToAllDevices((devices) => this.onUpstream(devices));
+    this.keepAlive = setInterval(() => {
+      this.dropSlowClients();
+      this.broadcast(': ping\n\n');
+    }, KEEPALIVE_MS);
+  }
+
+  private stopUpstream() {
+    console.log('[fanout] Sin clientes: cerrando suscripción upstream');
+    this.unsubscribe?.();
+    this.unsubscribe = null;
+    if (this.keepAlive) clearInterval(this.keepAlive);
+    this.keepAlive = null;
+  }
+
+  private onUpstream(devices: Record<string, RealtimeDeviceData>) {
+    const start = Date.now();
+    this.upstreamUpdates++;
+
+    const changed: DeviceDelta = {};
+    let hasChanges = false;
+
+    Object.entries(devices).forEach(([deviceId, next]) => {
+      const diff = diffDevice(this.state[deviceId], next);
+      if (diff) {
+        changed[deviceId] = diff;
+        hasChanges = true;
+      }
+    });
+
+    const removed = Object.keys(this.state).filter((deviceId) => !(deviceId in devices));
+    this.state = devices;
+    if (!hasChanges && removed.length === 0) return;
+
+    this.version++;
+    const payload = {
+      v: this.version,
+      sent: start,
+      devices: changed,
+      ...(removed.length > 0 ? { removed } : {}),
+    };
+    this.broadcast(formatEvent('delta', payload));
+    this.deltasSent++;
+    this.lastFanoutMs = Date.now() - start;
+  }
+
+  private write(client: FanoutClient, event: string, data: unknown) {
+    const chunk = formatEvent(event, data);
+    this.bytesSent += chunk.length;
+    if (!client.send(chunk)) client.staleSince = Date.now();
+  }
+
+  private broadcast(chunk: string) {
+    // Serializado una vez, enviado a todos; los atrasados esperan su resync
+    this.clients.forEach((client) => {
+      if (client.staleSince !== null) return;
+      this.bytesSent += chunk.length;
+      if (!client.send(chunk)) client.staleSince = Date.now();
+    });
+  }
+
+  private dropSlowClients() {
+    const now = Date.now();
+    this.clients.forEach((client) => {
+      if (client.staleSince === null || now - client.staleSince < SLOW_CLIENT_DROP_MS) return;
+      console.warn(`[fanout] Cliente ${client.id} sin leer desde hace ${now - client.staleSince} ms: cerrando`);
+      this.slowDropped++;
+      this.disconnect(client.id);
+      client.close();
+    });
+  }
+}
+
+function formatEvent(event: string, data: unknown): string {
+  return `event: ${event}\ndata: ${JSON.stringify(data)}\n\n`;
+}
+
+/**
+ * Campos que cambiaron respecto al estado anterior (null si ninguno); los que
+ * ya no están en next viajan como null
+ */
+function diffDevice(
+  prev: RealtimeDeviceData | undefined,
+  next: RealtimeDeviceData
+): Partial<RealtimeDeviceData> | null {
+  if (!prev) return next;
+
+  const diff: Partial<RealtimeDeviceData> = {};
+  let changed = false;
+  const keys = new Set([...Object.keys(prev), ...Object.keys(next)]) as Set<keyof RealtimeDeviceData>;
+  keys.forEach((key) => {
+    if (prev[key] !== next[key]) {
+      (diff as Record<string, unknown>)[key] = key in next ? next[key] : null;
+      changed = true;
+    }
+  });
+  return changed ? diff : null;
+}
+
+// Un único hub por proceso (sobrevive al HMR de `next dev`)
+const globalForFanout = globalThis as unknown as { fanoutHub?: FanoutHub };
+
+export function getFanoutHub(): FanoutHub {
+  if (!globalForFanout.fanoutHub) {
+    globalForFanout.fanoutHub = new FanoutHub();
+  }
+  return globalForFanout.fanoutHub;
+}
@@ -0,0 +1,94 @@
+import { FirebaseLectura } from './types';
+
+/**
+ * Decodificador de bloques DATA_BLK generados por el firmware
+ * (backend/src/HistoryCodec.cpp). Formato del flujo de bits, MSB primero:
+ *   - humo[0] en 16 bits, fuego[0] en 1 bit
+ *   - por cada muestra siguiente:
+ *       delta-of-delta del ts: '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32
+ *       delta de humo:         '0' | '10'+6 | '110'+9 | '111'+16
+ *       fuego en 1 bit
+ * Los valores con signo van en zigzag. ts[0] viaja fuera del bloque (t0).
+ */
+
+class BitReader {
+  private bytes: Uint8Array;
+  private pos = 0;
+
+  constructor(bytes: Uint8Array) {
+    this.bytes = bytes;
+  }
+
+  readBit(): number {
+    const byte = this.bytes[this.pos >> 3];
+    if (byte === undefined) throw new Error('Bloque DATA_BLK truncado');
+    const bit = (byte >> (7 - (this.pos & 7))) & 1;
+    this.pos++;
+    return bit;
+  }
+
+  readBits(count: number): number {
+    let value = 0;
+    for (let i = 0; i < count; i++) {
+      value = value * 2 + this.readBit();
+    }
+    return value;
+  }
+
+  // Cuenta los '1' iniciales del prefijo (hasta max)
+  readPrefix(max: number): number {
+    let ones = 0;
+    while (ones < max && this.readBit() === 1) ones++;
+    return ones;
+  }
+}
+
+function unzigzag(value: number): number {
+  return value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+}
+
+function base64ToBytes(encoded: string): Uint8Array {
+  const binary = atob(encoded);
+  const bytes = new Uint8Array(binary.length);
+  for (let i = 0; i < binary.length; i++) {
+    bytes[i] = binary.charCodeAt(i);
+  }
+  return bytes;
+}
+
+const TS_BITS = [0, 7, 9, 12, 32];
+const VALUE_BITS = [0, 6, 9, 16];
+
+/**
+ * Expande un bloque comprimido a lecturas individuales con el mismo formato
+ * que las lecturas DATA_HIST
+ */
+export function decodeHistoryBlock(
+  src: number,
+  t0: number,
+  count: number,
+  blk: string
+): FirebaseLectura[] {
+  const reader = new BitReader(base64ToBytes(blk));
+  const lecturas: FirebaseLectura[] = [];
+
+  let ts = t0;
+  let delta = 0;
+  let humo = reader.readBits(16);
+  let fuego = reader.readBit();
+  lecturas.push({ body: { ts, humo, fuego: fuego === 1 }, src, type: 'DATA_HIST' });
+
+  for (let i = 1; i < count; i++) {
+    const tsBits = TS_BITS[reader.readPrefix(4)];
+    delta += tsBits === 0 ? 0 : unzigzag(reader.readBits(tsBits));
+    ts += delta;
+
+    const valueBits = VALUE_BITS[reader.readPrefix(3)];
+    humo += valueBits === 0 ? 0 : unzigzag(reader.readBits(valueBits));
+    fuego = reader.readBit();
+
+    lecturas.push({ body: { ts, humo, fuego: fuego === 1 }, src, type: 'DATA_HIST' });
+  }
+
+  return lecturas;
+}
@@ -1,7 +1,16 @@
-import { ref, onValue, off, DataSnapshot } from 'firebase/database';
+import { ref, onValue, off, query, orderByKey, limitToLast, DataSnapshot } from 'firebase/database';
 import { database } from './firebase';
-import { RealtimeDeviceData, FirebaseNode, FirebaseLectura } from './types';
+import {
+  RealtimeDeviceData,
+  FirebaseNode,
+  FirebaseLectura,
+  FirebaseLecturaRecord,
+  FirebaseHistoryBlock,
+  FirebasePresence,
+  FirebaseSnapshot,
+} from './types';
 import { calculateAlertLevel } from './alerts';
+import { decodeHistoryBlock } from './historyCodec';
 
 /**
  * Estructura en Firebase:
@@ -10,10 +19,23 @@ import { calculateAlertLevel } from './alerts';
  *     - {key}: {
  *         body: { fuego: boolean, humo: number, ts: number },
  *         src: number (nodeId),
- *         type: string ("DATA" o "DATA_HIST")
+ *         type: string ("DATA", "DATA_FIRE" o "DATA_HIST")
  *       }
+ *     - {key}: bloque comprimido { type: "DATA_BLK", t0, t1, n, blk }
+ *   (las lecturas DATA con hora de red solo van en /snapshots)
+ * /presencia/{nodeId}: { online, hops, links, lastSeen } (lo mantiene el ROOT)
+ * /snapshots/{pushKey}: { ts, at, n, exp, nodes: { {nodeId}: { humo, fuego } } } (un registro por tick;
+ *   ts es la hora de red del ROOT y se reinicia con él, at es la hora del servidor;
+ *   late: true si son lecturas tardías de un tick cuyo registro no llegó a subirse)
  */
 
+// Ticks recientes que se leen para el estado en vivo (1 min a 5 s por tick):
+// un nodo que faltó al último snapshot conserva su lectura anterior
+const LIVE_SNAPSHOT_WINDOW = 12;
+
+// Ticks que se leen para el historial de un dispositivo
+const DEVICE_HISTORY_SNAPSHOTS = 50;
+
 // Mapeo de nodeId a deviceId y metadatos
 export const NODE_TO_DEVICE_MAP: Record<string, {
   deviceId: string;
@@ -45,12 +67,6 @@ export const NODE_TO_DEVICE_MAP: Record<string, {
   },
 };
 
-// Cache para guardar el timestamp de la última actualización POR DISPOSITIVO
-const lastSeenTimestamps: Record<string, {
-  serverTimestamp: number;  // Timestamp del ESP32
-  clientTimestamp: number;  // Timestamp local cuando lo vimos
-}> = {};
-
 /**
  * Obtener nodeId desde deviceId
  */
@@ -73,11 +89,45 @@ export function getDeviceInfoByDeviceId(deviceId: string) {
   return result;
 }
 
+function isHistoryBlock(record: FirebaseLecturaRecord): record is FirebaseHistoryBlock {
+  return record.type === 'DATA_BLK';
+}
+
+/**
+ * Expandir los bloques DATA_BLK a lecturas individuales
+ */
+function expandLecturas(
+  nodeId: string,
+  lecturas: Record<string, FirebaseLecturaRecord> | undefined
+): FirebaseLectura[] {
+  const result: FirebaseLectura[] = [];
+
+  Object.values(lecturas || {}).forEach((record) => {
+    if (!isHistoryBlock(record)) {
+      result.push(record);
+      return;
+    }
+
+    // El firmware escribe el bloque plano; se acepta también dentro de body
+    const block = record.body ?? record;
+    if (!block.blk || !block.n || block.t0 === undefined) return;
+
+    try {
+      const src = record.src ?? record.nodeId ?? Number(nodeId);
+      result.push(...decodeHistoryBlock(src, block.t0, block.n, block.blk));
+    } catch (error) {
+      console.error('Bloque DATA_BLK inválido para nodo', nodeId, error);
+    }
+  });
+
+  return result;
+}
+
 /**
  * Obtener la última lectura de un nodo
  */
-function getLatestLectura(lecturas: Record<string, FirebaseLectura>): FirebaseLectura | null {
-  const lecturasArray = Object.values(lecturas);
+function getLatestLectura(nodeId: string, lecturas: Record<string, FirebaseLecturaRecord>): FirebaseLectura | null {
+  const lecturasArray = expandLecturas(nodeId, lecturas);
   if (lecturasArray.length === 0) return null;
   
   // Filtrar solo lecturas con datos válidos y ordenar por ts descendente
@@ -86,22 +136,49 @@ function getLatestLectura(lecturas: Record<string, FirebaseLectura>): FirebaseLe
     .sort((a, b) => b.body.ts - a.body.ts)[0] || null;
 }
 
+/**
+ * Última lectura de un nodo en los snapshots (ordenados del más reciente al más antiguo)
+ */
+function getLatestFromSnapshots(nodeId: string, snapshots: FirebaseSnapshot[]): FirebaseLectura | null {
+  for (const snapshot of snapshots) {
+    const entry = snapshot.nodes?.[nodeId];
+    if (entry) {
+      return {
+        body: { ts: snapshot.ts, humo: entry.humo, fuego: Boolean(entry.fuego) },
+        src: Number(nodeId),
+        type: 'DATA',
+      };
+    }
+  }
+  return null;
+}
+
 /**
  * Convertir nodo de Firebase al formato RealtimeDeviceData
  */
 function convertFirebaseNode(
   nodeId: string,
-  node: FirebaseNode
+  node: FirebaseNode,
+  presence: FirebasePresence | undefined
 ): RealtimeDeviceData | null {
   console.log('Convirtiendo nodo:', nodeId, 'Lecturas:', Object.keys(node.lecturas || {}).length);
-  
+  return toDeviceData(nodeId, getLatestLectura(nodeId, node.lecturas), presence);
+}
+
+/**
+ * Construir RealtimeDeviceData a partir de la última lectura de un nodo
+ */
+function toDeviceData(
+  nodeId: string,
+  latestLectura: FirebaseLectura | null,
+  presence: FirebasePresence | undefined
+): RealtimeDeviceData | null {
   const deviceInfo = NODE_TO_DEVICE_MAP[nodeId];
   if (!deviceInfo) {
     console.warn('No se encontró deviceInfo para nodeId:', nodeId);
     return null;
   }
 
-  const latestLectura = getLatestLectura(node.lecturas);
   if (!latestLectura) {
     console.warn('No hay lecturas para nodeId:', nodeId);
     return null;
@@ -117,51 +194,8 @@ function convertFirebaseNode(
     flame: latestLectura.body.fuego ? 1 : 0,
   });
 
-  // ✅ DETECCIÓN CORRECTA DE ESTADO ONLINE
-  const currentServerTimestamp = latestLectura.body.ts;
-  const now = Date.now();
-  
-  // Verificar si ya vimos esta lectura antes
-  const lastSeen = lastSeenTimestamps[nodeId];
-  
-  let isOnline = false;
-  let razonamiento = '';
-  
-  if (!lastSeen) {
-    // Primera vez que vemos este dispositivo
-    lastSeenTimestamps[nodeId] = {
-      serverTimestamp: currentServerTimestamp,
-      clientTimestamp: now,
-    };
-    isOnline = true;
-    razonamiento = 'Primera lectura recibida - ONLINE';
-  } else if (currentServerTimestamp > lastSeen.serverTimestamp) {
-    // El serverTimestamp cambió = nueva lectura = dispositivo activo
-    lastSeenTimestamps[nodeId] = {
-      serverTimestamp: currentServerTimestamp,
-      clientTimestamp: now,
-    };
-    isOnline = true;
-    razonamiento = 'Nueva lectura detectada - ONLINE';
-  } else {
-    // El serverTimestamp NO cambió, verificar cuánto tiempo pasó desde la última actualización
-    const tiempoSinActualizar = now - lastSeen.clientTimestamp;
-    const timeoutMs = 60000; // 60 segundos
-    
-    isOnline = tiempoSinActualizar < timeoutMs;
-    razonamiento = isOnline 
-      ? `Sin cambios pero dentro del timeout (${Math.floor(tiempoSinActualizar / 1000)}s) - ONLINE`
-      : `Sin datos nuevos por ${Math.floor(tiempoSinActualizar / 1000)}s - OFFLINE`;
-  }
-
-  console.log('Estado del dispositivo:', {
-    nodeId,
-    currentServerTimestamp,
-    lastSeenServerTimestamp: lastSeen?.serverTimestamp,
-    tiempoTranscurrido: lastSeen ? `${Math.floor((now - lastSeen.clientTimestamp) / 1000)}s` : 'N/A',
-    isOnline,
-    razonamiento,
-  });
+  // El estado online lo decide el ROOT; sin entrada de presencia se asume offline
+  const isOnline = presence?.online ?? false;
 
   const result = {
     deviceId: deviceInfo.deviceId,
@@ -201,64 +235,140 @@ export function subscribeToDevice(
   callback: (data: RealtimeDeviceData | null) => void
 ): () => void {
   const nodeRef = ref(database, `nodos/${nodeId}`);
+  const presenceRef = ref(database, `presencia/${nodeId}`);
+
+  let nodeData: FirebaseNode | null = null;
+  let presence: FirebasePresence | undefined;
+
+  const emit = () => {
+    callback(nodeData ? convertFirebaseNode(nodeId, nodeData, presence) : null);
+  };
 
   onValue(nodeRef, (snapshot: DataSnapshot) => {
-    if (snapshot.exists()) {
-      const nodeData = snapshot.val() as FirebaseNode;
-      const deviceData = convertFirebaseNode(nodeId, nodeData);
-      callback(deviceData);
-    } else {
-      callback(null);
-    }
+    nodeData = snapshot.exists() ? (snapshot.val() as FirebaseNode) : null;
+    emit();
+  });
+
+  onValue(presenceRef, (snapshot: DataSnapshot) => {
+    presence = snapshot.exists() ? (snapshot.val() as FirebasePresence) : undefined;
+    emit();
   });
 
   return () => {
     off(nodeRef);
+    off(presenceRef);
   };
 }
 
 /**
- * Escucha cambios en tiempo real de todos los sensores
+ * Escucha cambios en tiempo real de todos los sensores.
+ * Las lecturas del tick llegan en /snapshots (un registro para toda la flota);
+ * de /nodos solo se lee el último registro de cada nodo, que cubre DATA_FIRE
+ * (fuera del tick) y los historiales
  */
 export function subscribeToAllDevices(
   callback: (devices: Record<string, RealtimeDeviceData>) => void
 ): () => void {
-  const nodosRef = ref(database, 'nodos');
-
-  onValue(nodosRef, (snapshot: DataSnapshot) => {
-    console.log('Snapshot recibido. Existe:', snapshot.exists());
-    
-    if (snapshot.exists()) {
-      const nodos = snapshot.val() as Record<string, FirebaseNode>;
-      console.log('Nodos encontrados:', Object.keys(nodos));
-      const devicesData: Record<string, RealtimeDeviceData> = {};
-
-      Object.entries(nodos).forEach(([nodeId, nodeData]) => {
-        console.log(`Procesando nodo: ${nodeId}`);
-        const deviceData = convertFirebaseNode(nodeId, nodeData);
-        if (deviceData) {
-          devicesData[deviceData.deviceId] = deviceData;
-        }
-      });
+  const snapshotsQuery = query(ref(database, 'snapshots'), orderByKey(), limitToLast(LIVE_SNAPSHOT_WINDOW));
+  const presenciaRef = ref(database, 'presencia');
+  const offTickQueries = Object.keys(NODE_TO_DEVICE_MAP).map(
+    (nodeId) => [nodeId, query(ref(database, `nodos/${nodeId}/lecturas`), orderByKey(), limitToLast(1))] as const
+  );
+
+  let snapshots: FirebaseSnapshot[] = [];
+  const offTick: Record<string, FirebaseLectura | null> = {};
+  let presencia: Record<string, FirebasePresence> = {};
+  let devicesData: Record<string, RealtimeDeviceData> = {};
+  let loaded = false;
+
+  const rebuild = () => {
+    devicesData = {};
+    Object.keys(NODE_TO_DEVICE_MAP).forEach((nodeId) => {
+      // ts es hora de red del ROOT en ambas fuentes: gana la más reciente
+      const fromSnapshot = getLatestFromSnapshots(nodeId, snapshots);
+      const fromNode = offTick[nodeId] ?? null;
+      const latest = !fromNode || (fromSnapshot && fromSnapshot.body.ts >= fromNode.body.ts)
+        ? fromSnapshot
+        : fromNode;
+
+      const deviceData = toDeviceData(nodeId, latest, presencia[nodeId]);
+      if (deviceData) {
+        devicesData[deviceData.deviceId] = deviceData;
+      }
+    });
+
+    loaded = true;
+    console.log('Datos actualizados en firebase', devicesData);
+    callback(devicesData);
+  };
+
+  onValue(snapshotsQuery, (snapshot: DataSnapshot) => {
+    // ts se repite tras reiniciar el ROOT: ordenar por hora del servidor
+    snapshots = snapshot.exists()
+      ? Object.values(snapshot.val() as Record<string, FirebaseSnapshot>)
+          .filter((s) => s.ts > 0)
+          .sort((a, b) => (b.at ?? 0) - (a.at ?? 0))
+      : [];
+    rebuild();
+  }, (error) => {
+    console.error('Error en subscribeToAllDevices:', error);
+  });
+
+  offTickQueries.forEach(([nodeId, lecturasQuery]) => {
+    onValue(lecturasQuery, (snapshot: DataSnapshot) => {
+      const lecturas = snapshot.exists()
+        ? (snapshot.val() as Record<string, FirebaseLecturaRecord>)
+        : undefined;
+      offTick[nodeId] = lecturas ? getLatestLectura(nodeId, lecturas) : null;
+      rebuild();
+    }, (error) => {
+      console.error('Error en lecturas de', nodeId, error);
+    });
+  });
+
+  // Un cambio de presencia solo actualiza isOnline; no se recalculan lecturas
+  onValue(presenciaRef, (snapshot: DataSnapshot) => {
+    presencia = snapshot.exists() ? (snapshot.val() as Record<string, FirebasePresence>) : {};
+
+    const updated: Record<string, RealtimeDeviceData> = {};
+    Object.entries(devicesData).forEach(([deviceId, device]) => {
+      const nodeId = getNodeIdFromDeviceId(deviceId);
+      const isOnline = nodeId ? presencia[nodeId]?.online ?? false : false;
+      updated[deviceId] = device.isOnline === isOnline ? device : { ...device, isOnline };
+    });
+    devicesData = updated;
 
-      console.log('Datos actualizados en firebase', devicesData);
+    if (loaded) {
       callback(devicesData);
-    } else {
-      console.error('No existen datos en /nodos');
-      callback({});
     }
   }, (error) => {
-    console.error('Error en subscribeToAllDevices:', error);
+    console.error('Error en presencia:', error);
   });
 
   return () => {
     console.log('Desuscribiendo de todos los nodos');
-    off(nodosRef);
+    off(snapshotsQuery);
+    offTickQueries.forEach(([, lecturasQuery]) => off(lecturasQuery));
+    off(presenciaRef);
   };
 }
 
 /**
- * Obtener todas las lecturas de un dispositivo específico (para historial)
+ * Lecturas de un nodo en los snapshots, en el formato de /nodos
+ */
+function getReadingsFromSnapshots(nodeId: string, snapshots: Record<string, FirebaseSnapshot>): FirebaseLectura[] {
+  return Object.values(snapshots)
+    .filter((snapshot) => snapshot.ts > 0 && snapshot.nodes?.[nodeId])
+    .map((snapshot) => ({
+      body: { ts: snapshot.ts, humo: snapshot.nodes[nodeId].humo, fuego: Boolean(snapshot.nodes[nodeId].fuego) },
+      src: Number(nodeId),
+      type: 'DATA',
+    }));
+}
+
+/**
+ * Obtener todas las lecturas de un dispositivo específico (para historial):
+ * las del tick desde /snapshots y el resto (DATA_FIRE, historiales) desde /nodos
  */
 export function subscribeToDeviceReadings(
   deviceId: string,
@@ -274,28 +384,118 @@ export function subscribeToDeviceReadings(
   }
 
   const lecturasRef = ref(database, `nodos/${nodeId}/lecturas`);
-  console.log('Suscribiendo a lecturas en:', `nodos/${nodeId}/lecturas`);
+  const snapshotsQuery = query(ref(database, 'snapshots'), orderByKey(), limitToLast(DEVICE_HISTORY_SNAPSHOTS));
+  console.log('Suscribiendo a lecturas en:', `nodos/${nodeId}/lecturas`, 'y snapshots');
+
+  let nodeReadings: FirebaseLectura[] = [];
+  let snapshotReadings: FirebaseLectura[] = [];
+
+  const emit = () => {
+    const lecturasArray = [...nodeReadings, ...snapshotReadings]
+      .filter(l => l.body && l.body.ts > 0)
+      .sort((a, b) => b.body.ts - a.body.ts);
+    console.log('Lecturas procesadas:', lecturasArray.length);
+    callback(lecturasArray);
+  };
 
   onValue(lecturasRef, (snapshot: DataSnapshot) => {
     console.log('Lecturas recibidas. Existe:', snapshot.exists());
-    
-    if (snapshot.exists()) {
-      const lecturasObj = snapshot.val() as Record<string, FirebaseLectura>;
-      const lecturasArray = Object.values(lecturasObj)
-        .filter(l => l.body && l.body.ts > 0)
-        .sort((a, b) => b.body.ts - a.body.ts);
-      console.log('Lecturas procesadas:', lecturasArray.length);
-      callback(lecturasArray);
-    } else {
-      console.warn('No hay lecturas para:', deviceId);
-      callback([]);
-    }
+    nodeReadings = snapshot.exists()
+      ? expandLecturas(nodeId, snapshot.val() as Record<string, FirebaseLecturaRecord>)
+      : [];
+    emit();
   }, (error) => {
     console.error('Error en subscribeToDeviceReadings:', error);
   });
 
+  onValue(snapshotsQuery, (snapshot: DataSnapshot) => {
+    snapshotReadings = snapshot.exists()
+      ? getReadingsFromSnapshots(nodeId, snapshot.val() as Record<string, FirebaseSnapshot>)
+      : [];
+    emit();
+  }, (error) => {
+    console.error('Error en snapshots de', deviceId, error);
+  });
+
   return () => {
     console.log('Desuscribiendo de lecturas:', deviceId);
     off(lecturasRef);
+    off(snapshotsQuery);
+  };
+}
+
+/**
+ * Últimos snapshots de flota (un registro por tick, todos los nodos juntos)
+ */
+export function subscribeToFleetSnapshots(
+  limit: number,
+  callback: (snapshots: FirebaseSnapshot[]) => void
+): () => void {
+  const snapshotsQuery = query(ref(database, 'snapshots'), orderByKey(), limitToLast(limit));
+
+  onValue(snapshotsQuery, (snapshot: DataSnapshot) => {
+    if (!snapshot.exists()) {
+      callback([]);
+      return;
+    }
+
+    // ts se repite tras reiniciar el ROOT: ordenar por hora del servidor, más reciente primero
+    const snapshots = Object.values(snapshot.val() as Record<string, FirebaseSnapshot>)
+      .filter((s) => s.ts > 0)
+      .sort((a, b) => (b.at ?? 0) - (a.at ?? 0));
+    callback(snapshots);
+  }, (error) => {
+    console.error('Error en subscribeToFleetSnapshots:', error);
+  });
+
+  return () => {
+    off(snapshotsQuery);
   };
-}
\ No newline at end of file
+}
+
+/**
+ * Estado de todos los dispositivos a través del hub SSE del servidor
+ * (/api/stream): una sola suscripción a Firebase para todos los dashboards
+ */
+export function subscribeToAllDevicesStream(
+  callback: (devices: Record<string, RealtimeDeviceData>) => void
+): () => void {
+  let devices: Record<string, RealtimeDeviceData> = {};
+  const source = new EventSource('/api/stream');
+
+  // Estado completo al conectar (y tras cada reconexión automática)
+  source.addEventListener('snapshot', (event) => {
+    devices = JSON.parse((event as MessageEvent).data).devices;
+    callback(devices);
+  });
+
+  // Solo los campos que cambiaron
+  source.addEventListener('delta', (event) => {
+    const delta = JSON.parse((event as MessageEvent).data) as {
+      devices: Record<string, Partial<RealtimeDeviceData>>;
+      removed?: string[];
+    };
+
+    const next = { ...devices };
+    Object.entries(delta.devices).forEach(([deviceId, fields]) => {
+      const merged: Record<string, unknown> = { ...next[deviceId], ...fields };
+      // null = el campo desapareció del dispositivo
+      Object.keys(merged).forEach((key) => {
+        if (merged[key] === null) delete merged[key];
+      });
+      next[deviceId] = merged as unknown as RealtimeDeviceData;
+    });
+    delta.removed?.forEach((deviceId) => delete next[deviceId]);
+
+    devices = next;
+    callback(devices);
+  });
+
+  source.onerror = () => {
+    console.warn('Stream SSE interrumpido, reconectando...');
+  };
+
+  return () => {
+    source.close();
+  };
+}
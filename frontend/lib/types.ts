@@ -56,8 +56,46 @@ export interface FirebaseLectura {
   type: string;
 }
 
+// Bloque comprimido de historial (backfill DATA_BLK); ver lib/historyCodec.ts
+export interface FirebaseHistoryBlock {
+  type: 'DATA_BLK';
+  src?: number;
+  nodeId?: number;
+  t0?: number;
+  t1?: number;
+  n?: number;
+  blk?: string;
+  body?: {
+    t0: number;
+    t1: number;
+    n: number;
+    blk: string;
+  };
+}
+
+export type FirebaseLecturaRecord = FirebaseLectura | FirebaseHistoryBlock;
+
+// Tabla de presencia mantenida por el ROOT en /presencia/{nodeId}
+export interface FirebasePresence {
+  online: boolean;
+  hops: number;
+  links: number;
+  lastSeen?: number;
+}
+
+// Snapshot de flota del ROOT en /snapshots/{pushKey}: todas las lecturas de un tick.
+// Un registro con late: true solo trae lecturas tardías (sin n ni exp)
+export interface FirebaseSnapshot {
+  ts: number;
+  at?: number;
+  n?: number;
+  exp?: number;
+  late?: boolean;
+  nodes: Record<string, { humo: number; fuego: number }>;
+}
+
 export interface FirebaseNode {
-  lecturas: Record<string, FirebaseLectura>;
+  lecturas: Record<string, FirebaseLecturaRecord>;
 }
 
 // Tipo para datos que llegan desde MQTT (ESP32)
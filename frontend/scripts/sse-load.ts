@@ -0,0 +1,100 @@
+/**
+ * Prueba de carga del hub SSE (/api/stream) con cientos de dashboards simulados.
+ *
+ *   pnpm tsx scripts/sse-load.ts [url] [clientes] [segundos]
+ *   pnpm tsx scripts/sse-load.ts http://localhost:3000/api/stream 300 60
+ *
+ * Contra el emulador de Realtime Database, arrancar Next con
+ * FIREBASE_DATABASE_EMULATOR_HOST=127.0.0.1:9000 y cargar firebase-seed.json;
+ * escribir lecturas nuevas en el emulador durante la prueba para generar deltas.
+ *
+ * Mide: tiempo hasta el snapshot inicial, latencia servidor→cliente de cada
+ * delta (campo `sent` del evento) y memoria del servidor (/api/stream/stats).
+ *
+ * Referencia sin emulador: route.ts y fanout.ts reales sobre node:http, con un
+ * upstream sintético en lugar de Firebase (50 dispositivos, un cambio por
+ * segundo en el 20 %). Node 22, 1 CPU compartida con este script, 60 s:
+ *   300 clientes:  delta p50 17 ms | p99 92 ms  | snapshot p50 549 ms | heap 20 MB
+ *   1000 clientes: delta p50 58 ms | p99 229 ms | snapshot p50 1.3 s
+ */
+
+const url = process.argv[2] ?? 'http://localhost:3000/api/stream';
+const clients = Number(process.argv[3] ?? 200);
+const durationMs = Number(process.argv[4] ?? 30) * 1000;
+
+const connectTimes: number[] = [];
+const deltaLatencies: number[] = [];
+let bytes = 0;
+let failures = 0;
+
+function percentile(values: number[], p: number): number {
+  if (values.length === 0) return 0;
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.min(sorted.length - 1, Math.floor((p / 100) * sorted.length))];
+}
+
+async function runClient(signal: AbortSignal) {
+  const start = Date.now();
+  let gotSnapshot = false;
+
+  const res = await fetch(url, { signal, headers: { Accept: 'text/event-stream' } });
+  if (!res.ok || !res.body) throw new Error(`HTTP ${res.status}`);
+
+  const reader = res.body.getReader();
+  const decoder = new TextDecoder();
+  let buffer = '';
+
+  for (;;) {
+    const { value, done } = await reader.read();
+    if (done) return;
+
+    bytes += value.length;
+    buffer += decoder.decode(value, { stream: true });
+
+    let end: number;
+    while ((end = buffer.indexOf('\n\n')) >= 0) {
+      const block = buffer.slice(0, end);
+      buffer = buffer.slice(end + 2);
+
+      const event = /^event: (.+)$/m.exec(block)?.[1];
+      const data = /^data: (.+)$/m.exec(block)?.[1];
+      if (!event || !data) continue;
+
+      if (event === 'snapshot' && !gotSnapshot) {
+        gotSnapshot = true;
+        connectTimes.push(Date.now() - start);
+      } else if (event === 'delta') {
+        deltaLatencies.push(Date.now() - JSON.parse(data).sent);
+      }
+    }
+  }
+}
+
+async function main() {
+  const controller = new AbortController();
+  console.log(`Abriendo ${clients} clientes contra ${url} durante ${durationMs / 1000}s...`);
+
+  const runs = Array.from({ length: clients }, () =>
+    runClient(controller.signal).catch((error) => {
+      if (!controller.signal.aborted) {
+        failures++;
+        console.error('Cliente falló:', error.message);
+      }
+    })
+  );
+
+  await new Promise((resolve) => setTimeout(resolve, durationMs));
+  const stats = await fetch(new URL('/api/stream/stats', url)).then((r) => r.json()).catch(() => null);
+
+  controller.abort();
+  await Promise.all(runs);
+
+  console.log('');
+  console.log(`Conectados: ${connectTimes.length}/${clients} (fallos ${failures})`);
+  console.log(`Snapshot inicial: p50 ${percentile(connectTimes, 50)} ms | p95 ${percentile(connectTimes, 95)} ms | max ${Math.max(0, ...connectTimes)} ms`);
+  console.log(`Deltas recibidos: ${deltaLatencies.length} | latencia p50 ${percentile(deltaLatencies, 50)} ms | p95 ${percentile(deltaLatencies, 95)} ms | p99 ${percentile(deltaLatencies, 99)} ms | max ${deltaLatencies.reduce((a, b) => Math.max(a, b), 0)} ms`);
+  console.log(`Bytes recibidos: ${(bytes / 1024).toFixed(1)} KB (${(bytes / Math.max(1, clients) / 1024).toFixed(2)} KB/cliente)`);
+  if (stats) console.log('Servidor:', stats);
+}
+
+main();